@@ -11,6 +11,13 @@
 #include "i2c.h"
 #include "spi.h"
 #include "../../kernel/stdio.h"
+#include "../../kernel/slab.h"
+#include "../../kernel/crc32.h"
+#include "../../kernel/dma_pool.h"
+#include "../../kernel/sched.h"
+#include "../../kernel/seqlock.h"
+#include "../../kernel/timer.h"
+#include "../../kernel/ai/ai_registry.h"
 #include <stdbool.h>
 
 // AI HAT+ I2C address
@@ -31,20 +38,61 @@
 #define AI_HAT_CMD_SET_POWER 0x03
 #define AI_HAT_CMD_LOAD_MODEL 0x10
 #define AI_HAT_CMD_UNLOAD_MODEL 0x11
+#define AI_HAT_CMD_LOAD_CHUNK 0x12
+#define AI_HAT_CMD_LOAD_COMMIT 0x13
 #define AI_HAT_CMD_RUN_INFERENCE 0x20
+#define AI_HAT_CMD_PIPELINE_STEP 0x21
+
+// Header that opens every bulk SPI transfer to the AI HAT+
+typedef struct {
+    uint8_t cmd;
+    uint8_t batch;              // Frames in an inference transfer, outputs
+                                // returned by a pipeline step, else 0
+    uint16_t model_id;
+    uint32_t length;            // Bytes that follow the header
+} __attribute__((aligned(4))) ai_hat_spi_header_t;
+
+// Follows the header of a LOAD_CHUNK transfer. The HAT answers the chunk
+// data with the CRC-32 it computed over it.
+typedef struct {
+    uint32_t offset;            // Of the chunk within the model
+    uint32_t total;             // Model bytes
+    uint32_t crc;               // CRC-32 of the chunk data
+} ai_hat_chunk_header_t;
+
+// Headers and acknowledgements of the upload transfers, in DMA-pool memory
+// owned by the upload. The caller sleeps through a DMA transfer while IRQ
+// and scheduler frames keep writing its stack, so a word received there
+// would share a cache line with live data.
+typedef struct {
+    ai_hat_spi_header_t header;
+    ai_hat_chunk_header_t chunk;
+    uint32_t crc;                   // Whole-model CRC-32 sent by LOAD_COMMIT
+    uint32_t ack __attribute__((aligned(CACHE_LINE_SIZE)));
+} ai_hat_upload_io_t;
+
+// Telemetry sampled by the background thread
+typedef struct {
+    uint32_t temperature;
+    uint32_t power_consumption;
+    uint64_t timestamp_ns;      // ktime_get_ns() of the last good sample
+} ai_hat_telemetry_t;
 
 // Static variables
 static bool ai_hat_initialized = false;
 static ai_hat_info_t ai_hat_info;
-static ai_hat_model_t loaded_models[8]; // Support up to 8 models
+// Models on the HAT live in the shared AI registry; model IDs are their
+// registry handles, allocated from the model cache on demand
+static kmem_cache_t* model_cache = NULL;
 static uint32_t num_loaded_models = 0;
+static uint32_t memory_used = 0;    // Model bytes resident or being uploaded
 
-// Delay function - simple busy wait
-static void __attribute__((unused)) delay(int32_t count) {
-    while (count--) {
-        asm volatile("nop");
-    }
-}
+// Latest telemetry, published by telemetry_sampler() under a seqlock so
+// the getters never touch the I2C bus
+static seqlock_t telemetry_lock = SEQLOCK_INIT;
+static ai_hat_telemetry_t telemetry;
+static volatile uint32_t telemetry_period_ms = AI_HAT_TELEMETRY_PERIOD_MS;
+static thread_t* telemetry_thread = NULL;
 
 // Initialize I2C for communication with AI HAT+
 static ai_hat_status_t init_i2c() {
@@ -97,8 +145,11 @@ static ai_hat_status_t init_spi() {
 static ai_hat_status_t send_command(uint8_t reg, uint8_t cmd, uint8_t* data, uint32_t len) {
     i2c_status_t status;
     
-    // Prepare command buffer
-    uint8_t cmd_buffer[len + 2];
+    // Prepare command buffer in a pinned pool buffer rather than on the stack
+    uint8_t* cmd_buffer = (uint8_t*)dma_buf_alloc(len + 2);
+    if (cmd_buffer == NULL) {
+        return AI_HAT_ERROR_MEMORY;
+    }
     cmd_buffer[0] = reg;
     cmd_buffer[1] = cmd;
     
@@ -109,6 +160,7 @@ static ai_hat_status_t send_command(uint8_t reg, uint8_t cmd, uint8_t* data, uin
     
     // Send command via I2C
     status = i2c_write(AI_HAT_I2C_ADDR, cmd_buffer, len + 2);
+    dma_buf_free(cmd_buffer);
     if (status != I2C_SUCCESS) {
         uart_puts("Failed to send command to AI HAT+\n");
         return AI_HAT_ERROR_COMM;
@@ -121,15 +173,8 @@ static ai_hat_status_t send_command(uint8_t reg, uint8_t cmd, uint8_t* data, uin
 static ai_hat_status_t read_data(uint8_t reg, uint8_t* data, uint32_t len) {
     i2c_status_t status;
     
-    // Send register address
-    status = i2c_write(AI_HAT_I2C_ADDR, &reg, 1);
-    if (status != I2C_SUCCESS) {
-        uart_puts("Failed to send register address to AI HAT+\n");
-        return AI_HAT_ERROR_COMM;
-    }
-    
-    // Read data
-    status = i2c_read(AI_HAT_I2C_ADDR, data, len);
+    // Send register address, then read after a repeated start
+    status = i2c_write_read(AI_HAT_I2C_ADDR, &reg, 1, data, len);
     if (status != I2C_SUCCESS) {
         uart_puts("Failed to read data from AI HAT+\n");
         return AI_HAT_ERROR_COMM;
@@ -137,14 +182,14 @@ static ai_hat_status_t read_data(uint8_t reg, uint8_t* data, uint32_t len) {
     
     // For simulation purposes, override with simulated data
     // In a real implementation, this would be removed
-    if (reg == AI_HAT_REG_VERSION) {
+    if (reg == AI_HAT_REG_VERSION && len >= 2) {
         // Simulate version information
         data[0] = 1; // Version 1.0
         data[1] = 0;
     } else if (reg == AI_HAT_REG_TEMP) {
         // Simulate temperature reading (45°C)
         data[0] = 45;
-    } else if (reg == AI_HAT_REG_POWER) {
+    } else if (reg == AI_HAT_REG_POWER && len >= 2) {
         // Simulate power consumption (1200mW)
         data[0] = 1200 & 0xFF;
         data[1] = (1200 >> 8) & 0xFF;
@@ -167,6 +212,52 @@ static ai_hat_status_t __attribute__((unused)) transfer_data(uint8_t* tx_data, u
     return AI_HAT_SUCCESS;
 }
 
+// Read temperature and power and publish them as the current snapshot
+static void sample_telemetry(void) {
+    uint8_t temp;
+    uint8_t power[2];
+    bool have_temp = read_data(AI_HAT_REG_TEMP, &temp, 1) == AI_HAT_SUCCESS;
+    bool have_power = read_data(AI_HAT_REG_POWER, power, 2) == AI_HAT_SUCCESS;
+    
+    if (!have_temp && !have_power) {
+        return;
+    }
+    
+    // A reader preempting the writer on this core would spin on it
+    preempt_disable();
+    write_seqlock(&telemetry_lock);
+    if (have_temp) {
+        telemetry.temperature = temp;
+    }
+    if (have_power) {
+        telemetry.power_consumption = (power[1] << 8) | power[0];
+    }
+    telemetry.timestamp_ns = ktime_get_ns();
+    write_sequnlock(&telemetry_lock);
+    preempt_enable();
+}
+
+// Consistent copy of the latest telemetry
+static void read_telemetry(ai_hat_telemetry_t* out) {
+    uint32_t seq;
+    do {
+        seq = read_seqbegin(&telemetry_lock);
+        *out = telemetry;
+    } while (read_seqretry(&telemetry_lock, seq));
+}
+
+// Background thread sampling telemetry while the AI HAT+ is up
+static void telemetry_sampler(void* arg) {
+    (void)arg;
+    
+    while (1) {
+        thread_sleep_ns((uint64_t)telemetry_period_ms * NSEC_PER_MSEC);
+        if (ai_hat_initialized) {
+            sample_telemetry();
+        }
+    }
+}
+
 // Initialize the AI HAT+
 ai_hat_status_t ai_hat_init(void) {
     ai_hat_status_t status;
@@ -210,23 +301,26 @@ ai_hat_status_t ai_hat_init(void) {
     // Initialize AI HAT+ information
     ai_hat_info.version = (version[0] << 8) | version[1];
     ai_hat_info.max_tops = 26; // 26 TOPS for AI HAT+
-    ai_hat_info.memory_size = 4 * 1024 * 1024; // 4GB in MB to avoid overflow
+    ai_hat_info.memory_size = 4 * 1024 * 1024; // Model memory in bytes
     ai_hat_info.power_mode = AI_HAT_POWER_MEDIUM;
     
-    // Read initial temperature and power consumption
-    uint8_t temp;
-    status = read_data(AI_HAT_REG_TEMP, &temp, 1);
-    if (status == AI_HAT_SUCCESS) {
-        ai_hat_info.temperature = temp;
-    }
-    
-    uint8_t power[2];
-    status = read_data(AI_HAT_REG_POWER, power, 2);
-    if (status == AI_HAT_SUCCESS) {
-        ai_hat_info.power_consumption = (power[1] << 8) | power[0];
+    // Take the first telemetry sample now, then keep it fresh in the background
+    sample_telemetry();
+    if (telemetry_thread == NULL) {
+        telemetry_thread = thread_create("ai_telemetry", telemetry_sampler, NULL);
+        if (telemetry_thread == NULL) {
+            uart_puts("AI HAT+ telemetry sampler not started\n");
+        }
     }
     
     // Initialize model list
+    if (model_cache == NULL) {
+        model_cache = kmem_cache_create("ai_hat_model", sizeof(ai_hat_model_t), 0, NULL);
+        if (model_cache == NULL) {
+            uart_puts("Failed to create AI HAT+ model cache\n");
+            return AI_HAT_ERROR_MEMORY;
+        }
+    }
     num_loaded_models = 0;
     
     ai_hat_initialized = true;
@@ -245,21 +339,12 @@ ai_hat_status_t ai_hat_get_info(ai_hat_info_t* info) {
         return AI_HAT_ERROR_PARAM;
     }
     
-    // Update temperature and power consumption
-    uint8_t temp;
-    ai_hat_status_t status = read_data(AI_HAT_REG_TEMP, &temp, 1);
-    if (status == AI_HAT_SUCCESS) {
-        ai_hat_info.temperature = temp;
-    }
-    
-    uint8_t power[2];
-    status = read_data(AI_HAT_REG_POWER, power, 2);
-    if (status == AI_HAT_SUCCESS) {
-        ai_hat_info.power_consumption = (power[1] << 8) | power[0];
-    }
-    
-    // Copy information to output
+    // Copy information to output, with the latest telemetry
+    ai_hat_telemetry_t sample;
+    read_telemetry(&sample);
     memcpy(info, &ai_hat_info, sizeof(ai_hat_info_t));
+    info->temperature = sample.temperature;
+    info->power_consumption = sample.power_consumption;
     
     return AI_HAT_SUCCESS;
 }
@@ -297,16 +382,10 @@ ai_hat_status_t ai_hat_get_temperature(uint32_t* temperature) {
         return AI_HAT_ERROR_PARAM;
     }
     
-    // Read temperature
-    uint8_t temp;
-    ai_hat_status_t status = read_data(AI_HAT_REG_TEMP, &temp, 1);
-    if (status != AI_HAT_SUCCESS) {
-        return status;
-    }
-    
-    // Update local information and output
-    ai_hat_info.temperature = temp;
-    *temperature = temp;
+    // Latest sample; the sampler thread does the bus traffic
+    ai_hat_telemetry_t sample;
+    read_telemetry(&sample);
+    *temperature = sample.temperature;
     
     return AI_HAT_SUCCESS;
 }
@@ -321,147 +400,460 @@ ai_hat_status_t ai_hat_get_power_consumption(uint32_t* power) {
         return AI_HAT_ERROR_PARAM;
     }
     
-    // Read power consumption
-    uint8_t power_data[2];
-    ai_hat_status_t status = read_data(AI_HAT_REG_POWER, power_data, 2);
-    if (status != AI_HAT_SUCCESS) {
-        return status;
-    }
+    // Latest sample; the sampler thread does the bus traffic
+    ai_hat_telemetry_t sample;
+    read_telemetry(&sample);
+    *power = sample.power_consumption;
     
-    // Update local information and output
-    ai_hat_info.power_consumption = (power_data[1] << 8) | power_data[0];
-    *power = ai_hat_info.power_consumption;
+    return AI_HAT_SUCCESS;
+}
+
+// Set how often the telemetry sampler reads the AI HAT+
+ai_hat_status_t ai_hat_set_telemetry_period(uint32_t period_ms) {
+    if (period_ms < AI_HAT_TELEMETRY_MIN_PERIOD_MS) {
+        return AI_HAT_ERROR_PARAM;
+    }
     
+    // Takes effect after the sampler's current sleep
+    telemetry_period_ms = period_ms;
     return AI_HAT_SUCCESS;
 }
 
-// Load a model to the AI HAT+
-ai_hat_status_t ai_hat_load_model(const void* model_data, uint32_t model_size, uint32_t* model_id) {
+// Free an upload's staging and transfer buffers
+static void upload_release_buffers(ai_hat_upload_t* upload) {
+    if (upload->chunk != NULL) {
+        dma_buf_free(upload->chunk);
+        upload->chunk = NULL;
+    }
+    if (upload->io != NULL) {
+        dma_buf_free(upload->io);
+        upload->io = NULL;
+    }
+}
+
+// Have the HAT drop whatever it holds for a model
+static ai_hat_status_t discard_model(uint32_t model_id) {
+    uint8_t id[2] = { (uint8_t)(model_id & 0xFF), (uint8_t)((model_id >> 8) & 0xFF) };
+    return send_command(AI_HAT_REG_MODEL, AI_HAT_CMD_UNLOAD_MODEL, id, 2);
+}
+
+// Prepare a streamed model upload
+ai_hat_status_t ai_hat_upload_init(ai_hat_upload_t* upload, uint32_t model_size) {
     if (!ai_hat_initialized) {
         return AI_HAT_ERROR_INIT;
     }
     
-    if (model_data == NULL || model_id == NULL || model_size == 0) {
+    if (upload == NULL || model_size == 0) {
         return AI_HAT_ERROR_PARAM;
     }
     
-    if (num_loaded_models >= 8) {
+    // Reserve the model's share of accelerator memory up front
+    if (model_size > ai_hat_memory_free()) {
         return AI_HAT_ERROR_MEMORY;
     }
     
-    // TODO: Implement actual model loading via SPI
-    // This is a placeholder for actual model loading code
+    memset(upload, 0, sizeof(ai_hat_upload_t));
+    upload->chunk = (uint8_t*)dma_buf_alloc(AI_HAT_UPLOAD_CHUNK);
+    upload->io = dma_buf_alloc(sizeof(ai_hat_upload_io_t));
+    if (upload->chunk == NULL || upload->io == NULL) {
+        upload_release_buffers(upload);
+        return AI_HAT_ERROR_MEMORY;
+    }
     
-    // For now, we'll simulate successful model loading
-    *model_id = num_loaded_models + 1;
+    // The ID is fixed now so a resumed upload lands on the same model; it
+    // resolves to nothing until the upload completes
+    upload->model_id = ai_registry_add(AI_REGISTRY_HAT_MODEL, NULL);
+    if (upload->model_id == 0) {
+        upload_release_buffers(upload);
+        return AI_HAT_ERROR_MEMORY;
+    }
+    memory_used += model_size;
+    upload->size = model_size;
     
-    // Add model to list
-    ai_hat_model_t* model = &loaded_models[num_loaded_models];
-    model->id = *model_id;
-    model->size = model_size;
-    model->precision = AI_HAT_PRECISION_FP16; // Default precision
-    model->input_size = 1024; // Example input size
-    model->output_size = 1000; // Example output size
+    return AI_HAT_SUCCESS;
+}
+
+// Release an unfinished upload
+void ai_hat_upload_abort(ai_hat_upload_t* upload) {
+    if (upload == NULL) {
+        return;
+    }
     
-    // Use a safer method than sprintf to create model name
-    char name_prefix[] = "Model_";
-    memcpy(model->name, name_prefix, sizeof(name_prefix) - 1);
+    // Only an unfinished upload still holds its reservation and buffers
+    if (upload->chunk != NULL) {
+        // Chunks the HAT already took would otherwise stay there
+        if (upload->bytes_sent > 0) {
+            discard_model(upload->model_id);
+        }
+        upload_release_buffers(upload);
+        memory_used -= upload->size;
+        ai_registry_remove(upload->model_id);
+    }
+}
+
+// Send one staged chunk; true if the HAT received it intact
+static bool upload_send_chunk(ai_hat_upload_t* upload, uint32_t chunk_crc) {
+    ai_hat_upload_io_t* io = (ai_hat_upload_io_t*)upload->io;
+    io->header = (ai_hat_spi_header_t){
+        AI_HAT_CMD_LOAD_CHUNK, 0, (uint16_t)upload->model_id,
+        sizeof(ai_hat_chunk_header_t) + upload->chunk_len
+    };
+    io->chunk = (ai_hat_chunk_header_t){ upload->offset, upload->size, chunk_crc };
+    io->ack = 0;
+    spi_segment_t segs[4] = {
+        { (const uint8_t*)&io->header, NULL, sizeof(io->header) },
+        { (const uint8_t*)&io->chunk, NULL, sizeof(io->chunk) },
+        { upload->chunk, NULL, upload->chunk_len },
+        { NULL, (uint8_t*)&io->ack, sizeof(io->ack) },
+    };
+    
+    upload->bytes_sent += upload->chunk_len;
+    return spi_transfer_sg(segs, 4) == SPI_SUCCESS && io->ack == chunk_crc;
+}
+
+// Ask the HAT to check the whole model and make it runnable. Returns
+// AI_HAT_ERROR_CHECKSUM if the HAT holds something other than what was sent.
+static ai_hat_status_t upload_commit(ai_hat_upload_t* upload) {
+    ai_hat_upload_io_t* io = (ai_hat_upload_io_t*)upload->io;
+    io->header = (ai_hat_spi_header_t){
+        AI_HAT_CMD_LOAD_COMMIT, 0, (uint16_t)upload->model_id, sizeof(uint32_t)
+    };
+    io->crc = upload->crc;
+    io->ack = 0;
+    spi_segment_t segs[3] = {
+        { (const uint8_t*)&io->header, NULL, sizeof(io->header) },
+        { (const uint8_t*)&io->crc, NULL, sizeof(io->crc) },
+        { NULL, (uint8_t*)&io->ack, sizeof(io->ack) },
+    };
+    
+    if (spi_transfer_sg(segs, 3) != SPI_SUCCESS) {
+        return AI_HAT_ERROR_COMM;
+    }
+    return io->ack == upload->crc ? AI_HAT_SUCCESS : AI_HAT_ERROR_CHECKSUM;
+}
+
+// Stream a model to the AI HAT+ in checksummed chunks
+ai_hat_status_t ai_hat_upload_model(ai_hat_upload_t* upload, ai_hat_model_reader_t reader, void* ctx,
+                                    uint32_t* model_id) {
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
+    }
     
-    // Convert model ID to string
-    char id_str[8];
-    int i = 0;
-    uint32_t id_copy = *model_id;
-    do {
-        id_str[i++] = '0' + (id_copy % 10);
-        id_copy /= 10;
-    } while (id_copy > 0 && i < 7);
-    id_str[i] = '\0';
+    if (upload == NULL || upload->chunk == NULL || upload->io == NULL || reader == NULL || model_id == NULL) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    ai_hat_model_t* model = (ai_hat_model_t*)kmem_cache_alloc(model_cache);
+    if (model == NULL) {
+        return AI_HAT_ERROR_MEMORY;
+    }
+    
+    uint64_t start = ktime_get_ns();
+    ai_hat_status_t status = AI_HAT_SUCCESS;
+    
+    while (upload->offset < upload->size) {
+        // A chunk still staged from an earlier failure is not read again,
+        // so stream sources that cannot rewind resume correctly
+        uint32_t want = upload->size - upload->offset;
+        if (want > AI_HAT_UPLOAD_CHUNK) {
+            want = AI_HAT_UPLOAD_CHUNK;
+        }
+        while (upload->chunk_len < want) {
+            int32_t got = reader(ctx, upload->offset + upload->chunk_len,
+                                 upload->chunk + upload->chunk_len, want - upload->chunk_len);
+            if (got <= 0) {
+                status = AI_HAT_ERROR_MODEL;
+                break;
+            }
+            upload->chunk_len += (uint32_t)got;
+        }
+        if (status != AI_HAT_SUCCESS) {
+            break;
+        }
+        
+        uint32_t chunk_crc = crc32_update(0, upload->chunk, upload->chunk_len);
+        bool sent = false;
+        for (uint32_t attempt = 0; attempt < AI_HAT_UPLOAD_RETRIES && !sent; attempt++) {
+            if (attempt > 0) {
+                upload->retries++;
+            }
+            sent = upload_send_chunk(upload, chunk_crc);
+        }
+        if (!sent) {
+            uart_printf("AI HAT+ upload stopped at %u of %u bytes\n",
+                        (unsigned int)upload->offset, (unsigned int)upload->size);
+            status = AI_HAT_ERROR_COMM;
+            break;
+        }
+        
+        upload->crc = crc32_update(upload->crc, upload->chunk, upload->chunk_len);
+        upload->offset += upload->chunk_len;
+        upload->chunk_len = 0;
+        upload->chunks++;
+    }
     
-    // Reverse the digits
-    for (int j = 0; j < i/2; j++) {
-        char temp = id_str[j];
-        id_str[j] = id_str[i-j-1];
-        id_str[i-j-1] = temp;
+    if (status == AI_HAT_SUCCESS) {
+        // A failed transfer leaves everything acknowledged in place, so
+        // resuming just commits again
+        status = upload_commit(upload);
+    }
+    if (status == AI_HAT_ERROR_CHECKSUM) {
+        // The HAT holds something other than what we sent. Have it drop
+        // the partial model; the upload starts over from offset 0, which
+        // the caller's reader has to be rewound to.
+        uart_puts("AI HAT+ model checksum mismatch\n");
+        discard_model(upload->model_id);
+        upload->offset = 0;
+        upload->crc = 0;
+        upload->chunks = 0;
     }
     
-    // Append to name (ensuring we don't overflow)
-    size_t prefix_len = sizeof(name_prefix) - 1;
-    size_t id_len = i;
-    if (prefix_len + id_len < sizeof(model->name)) {
-        memcpy(model->name + prefix_len, id_str, id_len + 1);
+    upload->elapsed_ns += ktime_get_ns() - start;
+    
+    if (status != AI_HAT_SUCCESS) {
+        kmem_cache_free(model_cache, model);
+        return status;
     }
     
+    // The reservation now belongs to the model
+    upload_release_buffers(upload);
+    *model_id = upload->model_id;
+    
+    // Fill in the model and publish it under its handle
+    model->id = upload->model_id;
+    model->size = upload->size;
+    model->precision = AI_HAT_PRECISION_FP16; // Default precision
+    model->input_size = 1024; // Placeholder until ai_hat_set_model_io()
+    model->output_size = 1000;
+    
+    snprintf(model->name, sizeof(model->name), "Model_%u", (unsigned int)upload->model_id);
+    
+    ai_registry_set(upload->model_id, model);
     num_loaded_models++;
     
     return AI_HAT_SUCCESS;
 }
 
+// Reader over a model already in memory
+int32_t ai_hat_memory_reader(void* ctx, uint32_t offset, void* buf, uint32_t len) {
+    memcpy(buf, (const uint8_t*)ctx + offset, len);
+    return (int32_t)len;
+}
+
+// Load a model to the AI HAT+
+ai_hat_status_t ai_hat_load_model(const void* model_data, uint32_t model_size, uint32_t* model_id) {
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
+    }
+    
+    if (model_data == NULL || model_id == NULL || model_size == 0) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    ai_hat_upload_t upload;
+    ai_hat_status_t status = ai_hat_upload_init(&upload, model_size);
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    status = ai_hat_upload_model(&upload, ai_hat_memory_reader, (void*)model_data, model_id);
+    if (status != AI_HAT_SUCCESS) {
+        uart_puts("Failed to send model to AI HAT+\n");
+        ai_hat_upload_abort(&upload);
+    }
+    
+    return status;
+}
+
 // Unload a model from the AI HAT+
 ai_hat_status_t ai_hat_unload_model(uint32_t model_id) {
     if (!ai_hat_initialized) {
         return AI_HAT_ERROR_INIT;
     }
     
-    // Find model in list
-    int model_index = -1;
-    for (uint32_t i = 0; i < num_loaded_models; i++) {
-        if (loaded_models[i].id == model_id) {
-            model_index = i;
-            break;
-        }
+    ai_hat_model_t* model = (ai_hat_model_t*)ai_registry_get(model_id, AI_REGISTRY_HAT_MODEL);
+    if (model == NULL) {
+        return AI_HAT_ERROR_PARAM;
     }
+    ai_registry_put(model_id);
     
-    if (model_index == -1) {
+    // Retire the handle and wait out inferences still using the model
+    // before the HAT drops it
+    if (!ai_registry_remove(model_id)) {
         return AI_HAT_ERROR_PARAM;
     }
+    num_loaded_models--;
     
-    // TODO: Implement actual model unloading
-    // This is a placeholder for actual model unloading code
+    // If the HAT did not confirm the unload, the model may still occupy
+    // its memory, so leave that charged
+    ai_hat_status_t status = discard_model(model_id);
+    if (status == AI_HAT_SUCCESS) {
+        memory_used -= model->size;
+    }
+    kmem_cache_free(model_cache, model);
     
-    // Remove model from list by shifting remaining models
-    for (uint32_t i = model_index; i < num_loaded_models - 1; i++) {
-        loaded_models[i] = loaded_models[i + 1];
+    return status;
+}
+
+// Run inference on a loaded model
+ai_hat_status_t ai_hat_run_inference(uint32_t model_id, const void* input, uint32_t input_size, void* output, uint32_t output_size) {
+    return ai_hat_run_inference_batch(model_id, &input, input_size, &output, output_size, 1);
+}
+
+// Send a batch to a referenced model and collect its outputs
+static ai_hat_status_t run_inference_batch(const ai_hat_model_t* model, const void* const* inputs, uint32_t input_size,
+                                           void* const* outputs, uint32_t output_size, uint32_t batch) {
+    // Check input and output sizes
+    if (input_size != model->input_size ||
+        output_size != model->output_size) {
+        return AI_HAT_ERROR_PARAM;
     }
     
-    num_loaded_models--;
+    // Send every input tensor and clock every output back under one CS;
+    // the header tells the HAT how many frames to run
+    ai_hat_spi_header_t header = {
+        AI_HAT_CMD_RUN_INFERENCE, (uint8_t)batch, (uint16_t)model->id, input_size * batch
+    };
+    spi_segment_t segs[1 + 2 * AI_HAT_MAX_BATCH];
+    segs[0] = (spi_segment_t){ (const uint8_t*)&header, NULL, sizeof(header) };
+    for (uint32_t i = 0; i < batch; i++) {
+        if (inputs[i] == NULL || outputs[i] == NULL) {
+            return AI_HAT_ERROR_PARAM;
+        }
+        segs[1 + i] = (spi_segment_t){ (const uint8_t*)inputs[i], NULL, input_size };
+        segs[1 + batch + i] = (spi_segment_t){ NULL, (uint8_t*)outputs[i], output_size };
+    }
+    if (spi_transfer_sg(segs, 1 + 2 * batch) != SPI_SUCCESS) {
+        uart_puts("Failed to run inference on AI HAT+\n");
+        return AI_HAT_ERROR_COMM;
+    }
     
     return AI_HAT_SUCCESS;
 }
 
-// Run inference on a loaded model
-ai_hat_status_t ai_hat_run_inference(uint32_t model_id, const void* input, uint32_t input_size, void* output, uint32_t output_size) {
+// Run inference on a batch of frames in one transfer and launch
+ai_hat_status_t ai_hat_run_inference_batch(uint32_t model_id, const void* const* inputs, uint32_t input_size,
+                                           void* const* outputs, uint32_t output_size, uint32_t batch) {
     if (!ai_hat_initialized) {
         return AI_HAT_ERROR_INIT;
     }
     
-    if (input == NULL || output == NULL) {
+    if (inputs == NULL || outputs == NULL || batch == 0 || batch > AI_HAT_MAX_BATCH) {
         return AI_HAT_ERROR_PARAM;
     }
     
-    // Find model in list
-    int model_index = -1;
-    for (uint32_t i = 0; i < num_loaded_models; i++) {
-        if (loaded_models[i].id == model_id) {
-            model_index = i;
-            break;
-        }
+    // The reference holds off unloading until the frames are back
+    ai_hat_model_t* model = (ai_hat_model_t*)ai_registry_get(model_id, AI_REGISTRY_HAT_MODEL);
+    if (model == NULL) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    ai_hat_status_t status = run_inference_batch(model, inputs, input_size, outputs, output_size, batch);
+    ai_registry_put(model_id);
+    
+    return status;
+}
+
+// Advance the streaming pipeline by one frame
+//
+// The HAT keeps three frame slots per pipeline. A step stores the
+// incoming input in a free slot, launches compute on the frame uploaded
+// by the previous step, and shifts out the oldest finished output. The
+// output comes back on MISO while the input goes out on MOSI, so the
+// download costs no extra bus time. A downloaded output is followed by
+// a word with the nanoseconds the HAT spent computing it.
+ai_hat_status_t ai_hat_pipeline_step(uint32_t model_id, const void* input, uint32_t input_size,
+                                     void* output, uint32_t output_size, uint32_t* compute_ns) {
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
     }
     
-    if (model_index == -1) {
+    if (input == NULL && output == NULL) {
         return AI_HAT_ERROR_PARAM;
     }
     
-    // Check input and output sizes
-    if (input_size != loaded_models[model_index].input_size ||
-        output_size != loaded_models[model_index].output_size) {
+    // The reference holds off unloading until the step is done
+    ai_hat_model_t* model = (ai_hat_model_t*)ai_registry_get(model_id, AI_REGISTRY_HAT_MODEL);
+    if (model == NULL) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    if ((input != NULL && input_size != model->input_size) ||
+        (output != NULL && output_size != model->output_size)) {
+        ai_registry_put(model_id);
         return AI_HAT_ERROR_PARAM;
     }
     
-    // TODO: Implement actual inference via SPI
-    // This is a placeholder for actual inference code
+    uint32_t tx_len = input != NULL ? input_size : 0;
+    uint32_t rx_len = output != NULL ? output_size : 0;
+    ai_hat_spi_header_t header = {
+        AI_HAT_CMD_PIPELINE_STEP, (uint8_t)(output != NULL), (uint16_t)model_id, tx_len
+    };
+    
+    // Header, then the overlap of input and output full duplex, then
+    // whichever of the two is longer on its own
+    uint32_t both = tx_len < rx_len ? tx_len : rx_len;
+    spi_segment_t segs[4];
+    uint32_t count = 0;
+    segs[count++] = (spi_segment_t){ (const uint8_t*)&header, NULL, sizeof(header) };
+    if (both > 0) {
+        segs[count++] = (spi_segment_t){ (const uint8_t*)input, (uint8_t*)output, both };
+    }
+    if (tx_len > both) {
+        segs[count++] = (spi_segment_t){ (const uint8_t*)input + both, NULL, tx_len - both };
+    } else if (rx_len > both) {
+        segs[count++] = (spi_segment_t){ NULL, (uint8_t*)output + both, rx_len - both };
+    }
+    
+    // The compute time is received into the DMA pool, not the stack
+    uint32_t* trailer = NULL;
+    if (output != NULL) {
+        trailer = (uint32_t*)dma_buf_alloc(sizeof(uint32_t));
+        if (trailer == NULL) {
+            ai_registry_put(model_id);
+            return AI_HAT_ERROR_MEMORY;
+        }
+        *trailer = 0;
+        segs[count++] = (spi_segment_t){ NULL, (uint8_t*)trailer, sizeof(uint32_t) };
+    }
+    
+    ai_hat_status_t status = AI_HAT_SUCCESS;
+    if (spi_transfer_sg(segs, count) != SPI_SUCCESS) {
+        uart_puts("Failed to run pipeline step on AI HAT+\n");
+        status = AI_HAT_ERROR_COMM;
+    } else if (trailer != NULL && compute_ns != NULL) {
+        *compute_ns = *trailer;
+    }
+    
+    if (trailer != NULL) {
+        dma_buf_free(trailer);
+    }
+    ai_registry_put(model_id);
+    return status;
+}
+
+// Model memory not yet taken by resident or uploading models
+uint32_t ai_hat_memory_free(void) {
+    return memory_used < ai_hat_info.memory_size ? ai_hat_info.memory_size - memory_used : 0;
+}
+
+// Set the per-frame tensor sizes of a loaded model
+ai_hat_status_t ai_hat_set_model_io(uint32_t model_id, uint32_t input_size, uint32_t output_size) {
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
+    }
+    
+    if (input_size == 0 || output_size == 0) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    ai_hat_model_t* model = (ai_hat_model_t*)ai_registry_get(model_id, AI_REGISTRY_HAT_MODEL);
+    if (model == NULL) {
+        return AI_HAT_ERROR_PARAM;
+    }
     
-    // For now, we'll simulate successful inference with dummy output
-    memset(output, 0, output_size);
+    model->input_size = input_size;
+    model->output_size = output_size;
+    ai_registry_put(model_id);
     
     return AI_HAT_SUCCESS;
 }
@@ -477,9 +869,14 @@ ai_hat_status_t ai_hat_get_models(ai_hat_model_t* models, uint32_t max_models, u
     }
     
     // Copy models to output
-    uint32_t count = (num_loaded_models < max_models) ? num_loaded_models : max_models;
-    for (uint32_t i = 0; i < count; i++) {
-        models[i] = loaded_models[i];
+    uint32_t count = 0;
+    uint32_t cursor = 0;
+    uint32_t model_id;
+    ai_hat_model_t* model;
+    while (count < max_models &&
+           (model = (ai_hat_model_t*)ai_registry_next(AI_REGISTRY_HAT_MODEL, &cursor, &model_id)) != NULL) {
+        models[count++] = *model;
+        ai_registry_put(model_id);
     }
     
     *num_models = count;
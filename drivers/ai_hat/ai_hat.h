@@ -11,6 +11,13 @@
 
 #include "../../kernel/types.h"
 
+// Telemetry sampling period, and the shortest one allowed
+#define AI_HAT_TELEMETRY_PERIOD_MS      1000
+#define AI_HAT_TELEMETRY_MIN_PERIOD_MS  10
+
+// Most frames one inference transfer can carry
+#define AI_HAT_MAX_BATCH 16
+
 // AI HAT+ status codes
 typedef enum {
     AI_HAT_SUCCESS = 0,
@@ -19,9 +26,16 @@ typedef enum {
     AI_HAT_ERROR_PARAM = -3,
     AI_HAT_ERROR_MODEL = -4,
     AI_HAT_ERROR_MEMORY = -5,
-    AI_HAT_ERROR_TIMEOUT = -6
+    AI_HAT_ERROR_TIMEOUT = -6,
+    AI_HAT_ERROR_CHECKSUM = -7      // Upload restarted; rewind the reader
 } ai_hat_status_t;
 
+// Bytes per chunk of a streamed model upload
+#define AI_HAT_UPLOAD_CHUNK     16384
+
+// Attempts per chunk before a streamed upload stops (it can be resumed)
+#define AI_HAT_UPLOAD_RETRIES   3
+
 // AI HAT+ power modes
 typedef enum {
     AI_HAT_POWER_OFF = 0,
@@ -43,7 +57,7 @@ typedef enum {
 typedef struct {
     uint32_t version;
     uint32_t max_tops;
-    uint32_t memory_size;
+    uint32_t memory_size;       // Model memory in bytes
     uint32_t temperature;
     uint32_t power_consumption;
     ai_hat_power_mode_t power_mode;
@@ -59,30 +73,96 @@ typedef struct {
     uint32_t output_size;
 } ai_hat_model_t;
 
+// Source of a streamed model: copies up to len bytes at offset into buf
+// and returns the count, or a negative value on error. Offsets are asked
+// for in increasing order, each chunk only once, except that after
+// AI_HAT_ERROR_CHECKSUM the upload starts again from offset 0.
+typedef int32_t (*ai_hat_model_reader_t)(void* ctx, uint32_t offset, void* buf, uint32_t len);
+
+// Reader over a model already in memory; ctx points at the model data
+int32_t ai_hat_memory_reader(void* ctx, uint32_t offset, void* buf, uint32_t len);
+
+// Progress of a streamed model upload. Survives a failed
+// ai_hat_upload_model() so the upload can resume where it stopped.
+typedef struct {
+    uint32_t model_id;
+    uint32_t size;              // Model bytes
+    uint32_t offset;            // Bytes the HAT has acknowledged
+    uint32_t crc;               // CRC-32 of the acknowledged bytes
+    uint8_t* chunk;             // Staged chunk at offset, kept for resends
+    void* io;                   // Transfer headers and acknowledgements
+    uint32_t chunk_len;         // Bytes staged in chunk
+    uint32_t chunks;            // Chunks acknowledged
+    uint32_t retries;           // Chunks sent again after an error
+    uint64_t bytes_sent;        // Including resends
+    uint64_t elapsed_ns;        // Time spent in ai_hat_upload_model()
+} ai_hat_upload_t;
+
 // Initialize the AI HAT+
 ai_hat_status_t ai_hat_init(void);
 
-// Get AI HAT+ information
+// Get AI HAT+ information. Temperature and power come from the latest
+// telemetry sample and cost no bus traffic.
 ai_hat_status_t ai_hat_get_info(ai_hat_info_t* info);
 
 // Set AI HAT+ power mode
 ai_hat_status_t ai_hat_set_power_mode(ai_hat_power_mode_t mode);
 
-// Get AI HAT+ temperature (in Celsius)
+// Get AI HAT+ temperature (in Celsius) from the latest telemetry sample
 ai_hat_status_t ai_hat_get_temperature(uint32_t* temperature);
 
-// Get AI HAT+ power consumption (in mW)
+// Get AI HAT+ power consumption (in mW) from the latest telemetry sample
 ai_hat_status_t ai_hat_get_power_consumption(uint32_t* power);
 
-// Load a model to the AI HAT+
+// Set the telemetry sampling period, at least AI_HAT_TELEMETRY_MIN_PERIOD_MS
+ai_hat_status_t ai_hat_set_telemetry_period(uint32_t period_ms);
+
+// Load a model in memory to the AI HAT+, streamed as for ai_hat_upload_model()
 ai_hat_status_t ai_hat_load_model(const void* model_data, uint32_t model_size, uint32_t* model_id);
 
-// Unload a model from the AI HAT+
+// Prepare a streamed upload of a model_size byte model
+ai_hat_status_t ai_hat_upload_init(ai_hat_upload_t* upload, uint32_t model_size);
+
+// Stream the model in AI_HAT_UPLOAD_CHUNK chunks, each checked by CRC-32
+// and resent up to AI_HAT_UPLOAD_RETRIES times. On failure the upload
+// stays valid; calling again resumes from upload->offset. If the CRC of
+// the whole model does not match at the end, the HAT drops what it got
+// and this returns AI_HAT_ERROR_CHECKSUM with upload->offset back at 0:
+// resume only with a reader that can start over, otherwise abort.
+ai_hat_status_t ai_hat_upload_model(ai_hat_upload_t* upload, ai_hat_model_reader_t reader, void* ctx,
+                                    uint32_t* model_id);
+
+// Release an upload that will not be completed
+void ai_hat_upload_abort(ai_hat_upload_t* upload);
+
+// Unload a model from the AI HAT+. Waits for inferences still using the
+// model. The handle is retired even if the HAT fails to confirm.
 ai_hat_status_t ai_hat_unload_model(uint32_t model_id);
 
 // Run inference on a loaded model
 ai_hat_status_t ai_hat_run_inference(uint32_t model_id, const void* input, uint32_t input_size, void* output, uint32_t output_size);
 
+// Run inference on batch frames of input_size bytes each in one transfer
+// and launch, writing output_size bytes per frame. batch is at most
+// AI_HAT_MAX_BATCH.
+ai_hat_status_t ai_hat_run_inference_batch(uint32_t model_id, const void* const* inputs, uint32_t input_size,
+                                           void* const* outputs, uint32_t output_size, uint32_t batch);
+
+// Advance the streaming pipeline of a model by one step: upload input
+// (NULL when draining) while downloading the output of the frame uploaded
+// two steps earlier into output (NULL while the pipeline fills). The HAT
+// computes the frame in between meanwhile. With an output, *compute_ns
+// (if not NULL) gets the time the HAT spent computing that frame.
+ai_hat_status_t ai_hat_pipeline_step(uint32_t model_id, const void* input, uint32_t input_size,
+                                     void* output, uint32_t output_size, uint32_t* compute_ns);
+
+// Bytes of model memory (ai_hat_info_t.memory_size) still free. Uploads
+// reserve their model's size when they start and fail if it does not fit.
+uint32_t ai_hat_memory_free(void);
+
+// Set the per-frame input and output tensor sizes of a loaded model
+ai_hat_status_t ai_hat_set_model_io(uint32_t model_id, uint32_t input_size, uint32_t output_size);
+
 // Get list of loaded models
 ai_hat_status_t ai_hat_get_models(ai_hat_model_t* models, uint32_t max_models, uint32_t* num_models);
 
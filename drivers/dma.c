@@ -0,0 +1,193 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ *
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "dma.h"
+#include "intc.h"
+#include "../kernel/cache.h"
+#include "../kernel/irq.h"
+#include "../kernel/mmu.h"
+#include "../kernel/slab.h"
+
+// Raspberry Pi 5 DMA registers
+#define RPI5_PERIPHERAL_BASE 0xFE000000
+
+// Where the DMA engine sees peripherals and RAM on its bus. RAM is
+// reached through the uncached alias, which covers the first 1 GB.
+#define DMA_BUS_PERIPHERAL  0x7E000000
+#define DMA_BUS_RAM         0xC0000000
+
+// Per-channel registers, 0x100 apart
+#define DMA_BASE            (RPI5_PERIPHERAL_BASE + 0x007000)
+#define DMA_CHAN(n)         (DMA_BASE + (uintptr_t)(n) * 0x100)
+#define DMA_CS(n)           ((volatile uint32_t*)(DMA_CHAN(n) + 0x00))
+#define DMA_CONBLK_AD(n)    ((volatile uint32_t*)(DMA_CHAN(n) + 0x04))
+#define DMA_DEBUG(n)        ((volatile uint32_t*)(DMA_CHAN(n) + 0x20))
+
+// Global registers
+#define DMA_INT_STATUS      ((volatile uint32_t*)(DMA_BASE + 0xFE0))
+#define DMA_ENABLE          ((volatile uint32_t*)(DMA_BASE + 0xFF0))
+
+// Channel CS register bits
+#define DMA_CS_ACTIVE       (1U << 0)
+#define DMA_CS_END          (1U << 1)
+#define DMA_CS_INT          (1U << 2)
+#define DMA_CS_ERROR        (1U << 8)
+#define DMA_CS_PRIORITY(n)  ((uint32_t)(n) << 16)
+#define DMA_CS_PANIC_PRIORITY(n) ((uint32_t)(n) << 20)
+#define DMA_CS_WAIT_WRITES  (1U << 28)
+#define DMA_CS_ABORT        (1U << 30)
+#define DMA_CS_RESET        (1U << 31)
+
+// Write-one-to-clear error flags in the DEBUG register
+#define DMA_DEBUG_ERRORS    0x7
+
+// Channels with a dedicated interrupt line
+#define DMA_IRQ_CHANNELS    11
+
+// Priority used for every transfer
+#define DMA_CS_RUN          (DMA_CS_ACTIVE | DMA_CS_PRIORITY(8) | DMA_CS_PANIC_PRIORITY(15) | \
+                             DMA_CS_WAIT_WRITES)
+
+typedef struct {
+    dma_callback_t callback;
+    void* arg;
+    bool claimed;
+} dma_channel_t;
+
+static dma_channel_t channels[DMA_CHANNELS];
+
+// Channel interrupt: acknowledge it and report completion or failure
+static void dma_irq(uint32_t irq, void* arg) {
+    (void)irq;
+    uint32_t channel = (uint32_t)(uintptr_t)arg;
+
+    uint32_t cs = *DMA_CS(channel);
+    if (!(cs & (DMA_CS_INT | DMA_CS_ERROR))) {
+        return;
+    }
+
+    // Clear INT and END; both are write-one-to-clear
+    *DMA_CS(channel) = cs & (DMA_CS_INT | DMA_CS_END);
+
+    bool error = (cs & DMA_CS_ERROR) != 0;
+    if (error) {
+        *DMA_DEBUG(channel) = DMA_DEBUG_ERRORS;
+    }
+
+    dma_channel_t* chan = &channels[channel];
+    if (chan->callback) {
+        chan->callback(channel, error, chan->arg);
+    }
+}
+
+// Claim a channel and attach its completion interrupt
+bool dma_channel_request(uint32_t channel, dma_callback_t callback, void* arg) {
+    if (channel >= DMA_IRQ_CHANNELS) {
+        return false;
+    }
+
+    if (__atomic_exchange_n(&channels[channel].claimed, true, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+
+    channels[channel].callback = callback;
+    channels[channel].arg = arg;
+
+    // Enable and reset the channel before its interrupt can fire
+    *DMA_ENABLE |= 1U << channel;
+    *DMA_CS(channel) = DMA_CS_RESET;
+    *DMA_CS(channel) = DMA_CS_INT | DMA_CS_END;
+
+    if (!irq_register(IRQ_DMA(channel), dma_irq, (void*)(uintptr_t)channel)) {
+        __atomic_store_n(&channels[channel].claimed, false, __ATOMIC_RELEASE);
+        return false;
+    }
+    return true;
+}
+
+// Stop a channel and release it
+void dma_channel_release(uint32_t channel) {
+    if (channel >= DMA_IRQ_CHANNELS || !channels[channel].claimed) {
+        return;
+    }
+
+    irq_unregister(IRQ_DMA(channel));
+    *DMA_CS(channel) = DMA_CS_RESET;
+    *DMA_ENABLE &= ~(1U << channel);
+
+    channels[channel].callback = NULL;
+    channels[channel].arg = NULL;
+    __atomic_store_n(&channels[channel].claimed, false, __ATOMIC_RELEASE);
+}
+
+// Start a channel on a chain of control blocks
+void dma_start(uint32_t channel, const dma_cb_t* cb) {
+    // Control blocks and buffers must reach memory before the engine reads them
+#if defined(__aarch64__)
+    asm volatile("dsb sy" ::: "memory");
+#endif
+    *DMA_CONBLK_AD(channel) = dma_bus_addr(cb);
+    *DMA_CS(channel) = DMA_CS_RUN;
+}
+
+// Stop a channel mid-chain
+void dma_abort(uint32_t channel) {
+    *DMA_CS(channel) = DMA_CS_RESET;
+}
+
+// Whether a channel is still running its chain
+bool dma_busy(uint32_t channel) {
+    return (*DMA_CS(channel) & DMA_CS_ACTIVE) != 0;
+}
+
+// Bus address of RAM as seen by the DMA engine
+uint32_t dma_bus_addr(const void* ram) {
+    return (uint32_t)(uintptr_t)ram | DMA_BUS_RAM;
+}
+
+// Bus address of a peripheral register as seen by the DMA engine
+uint32_t dma_periph_addr(volatile uint32_t* reg) {
+    return (uint32_t)((uintptr_t)reg - RPI5_PERIPHERAL_BASE) + DMA_BUS_PERIPHERAL;
+}
+
+// Whether a buffer lies in the RAM the DMA engine can address
+bool dma_addressable(const void* ram, size_t len) {
+    uintptr_t start = (uintptr_t)ram;
+    return start < DMA_RAM_LIMIT && len <= DMA_RAM_LIMIT - start;
+}
+
+// Whether a buffer can receive DMA in place. A partial line at either end
+// is shared with other data: invalidating it drops that data's updates,
+// and evicting it writes stale bytes over what the engine delivered.
+bool dma_rx_safe(const void* ram, size_t len) {
+    return (((uintptr_t)ram | len) & (CACHE_LINE_SIZE - 1)) == 0 && dma_addressable(ram, len);
+}
+
+// Hand a buffer to the device: TX data is written back; RX lines are
+// also invalidated so no dirty line can land on top of the incoming data
+void dma_sync_for_device(const void* ram, size_t len, dma_dir_t dir) {
+    if (!mmu_enabled() || len == 0) {
+        return;
+    }
+
+    if (dir == DMA_TO_DEVICE) {
+        dcache_clean_range(ram, len);
+    } else {
+        dcache_flush_range(ram, len);
+    }
+}
+
+// Take a buffer back from the device: speculative fills during the
+// transfer may hold stale copies of RX data
+void dma_sync_for_cpu(void* ram, size_t len, dma_dir_t dir) {
+    if (!mmu_enabled() || len == 0 || dir != DMA_FROM_DEVICE) {
+        return;
+    }
+
+    dcache_inval_range(ram, len);
+}
@@ -0,0 +1,98 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ *
+ * ───────────────────────────────────────────────────────────────────────────── */
+#ifndef DMA_H
+#define DMA_H
+
+#include "types.h"
+#include <stdbool.h>
+
+// BCM283x DMA engine (channels 0-14). Each channel walks a chain of
+// control blocks in memory and raises an interrupt at the end of any
+// block with DMA_TI_INTEN set.
+
+#define DMA_CHANNELS        15
+
+// Control block transfer information (TI) bits
+#define DMA_TI_INTEN        (1 << 0)
+#define DMA_TI_WAIT_RESP    (1 << 3)
+#define DMA_TI_DEST_INC     (1 << 4)
+#define DMA_TI_DEST_DREQ    (1 << 6)
+#define DMA_TI_DEST_IGNORE  (1 << 7)
+#define DMA_TI_SRC_INC      (1 << 8)
+#define DMA_TI_SRC_DREQ     (1 << 10)
+#define DMA_TI_PERMAP(n)    ((uint32_t)(n) << 16)
+
+// Peripherals that pace transfers through DREQ
+#define DMA_DREQ_SPI0_TX    6
+#define DMA_DREQ_SPI0_RX    7
+
+// Longest single control block
+#define DMA_MAX_LEN         0x3FFFFFFF
+
+// Highest RAM address the DMA engine can reach through its bus window
+#define DMA_RAM_LIMIT       0x40000000UL
+
+// Control block; read by the engine, so it must be 32-byte aligned and
+// cleaned to memory before the channel is started
+typedef struct {
+    uint32_t ti;
+    uint32_t source_ad;
+    uint32_t dest_ad;
+    uint32_t txfr_len;
+    uint32_t stride;
+    uint32_t nextconbk;
+    uint32_t reserved[2];
+} __attribute__((aligned(32))) dma_cb_t;
+
+// Called from the channel's interrupt when a block with DMA_TI_INTEN
+// completes, or with error set if the channel stopped on an error
+typedef void (*dma_callback_t)(uint32_t channel, bool error, void* arg);
+
+// Direction of a buffer shared with a DMA transfer
+typedef enum {
+    DMA_TO_DEVICE,
+    DMA_FROM_DEVICE
+} dma_dir_t;
+
+// Claim a channel and attach its completion interrupt. Fails if the
+// channel is taken or no interrupt can be delivered on this platform.
+bool dma_channel_request(uint32_t channel, dma_callback_t callback, void* arg);
+
+// Stop a channel and release it
+void dma_channel_release(uint32_t channel);
+
+// Start a channel on a chain of control blocks
+void dma_start(uint32_t channel, const dma_cb_t* cb);
+
+// Stop a channel mid-chain
+void dma_abort(uint32_t channel);
+
+// Whether a channel is still running its chain
+bool dma_busy(uint32_t channel);
+
+// Bus addresses as seen by the DMA engine
+uint32_t dma_bus_addr(const void* ram);
+uint32_t dma_periph_addr(volatile uint32_t* reg);
+
+// Whether a buffer lies in the RAM the DMA engine can address
+bool dma_addressable(const void* ram, size_t len);
+
+// Whether a buffer can receive DMA in place: addressable, and owning every
+// cache line it touches, since the syncs invalidate whole lines
+bool dma_rx_safe(const void* ram, size_t len);
+
+// Hand a buffer to the device: write back TX data, and for RX drop lines
+// that could be evicted over the incoming data. The buffer must not share
+// cache lines with data the CPU touches while the transfer runs.
+void dma_sync_for_device(const void* ram, size_t len, dma_dir_t dir);
+
+// Take a buffer back from the device: discard stale lines of RX data
+void dma_sync_for_cpu(void* ram, size_t len, dma_dir_t dir);
+
+#endif // DMA_H
@@ -7,6 +7,11 @@
  * ───────────────────────────────────────────────────────────────────────────── */
 #include "i2c.h"
 #include "uart.h"
+#include "intc.h"
+#include "../kernel/irq.h"
+#include "../kernel/sched.h"
+#include "../kernel/spinlock.h"
+#include "../kernel/timer.h"
 #include <stdbool.h>
 
 // Raspberry Pi 5 I2C registers
@@ -47,37 +52,194 @@
 // I2C clock divider
 #define I2C_CLOCK_FREQ      150000000  // 150 MHz
 
+// Longest a transfer may take to complete
+#define I2C_TIMEOUT_US      1000000
+
+// Error and completion flags, cleared by writing them back
+#define I2C_S_CLEAR         (I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE)
+
 // Static variables
 static bool i2c_initialized = false;
 
-// Delay function - simple busy wait
-static void delay(int32_t count) {
-    while (count--) {
-        asm volatile("nop");
+// Transaction engine state, protected by i2c_lock. The head of the queue
+// is the transaction on the bus.
+static spinlock_t i2c_lock = SPINLOCK_INIT;
+static i2c_xfer_t* queue_head = NULL;
+static i2c_xfer_t* queue_tail = NULL;
+static uint64_t active_deadline;
+
+// Whether the BSC interrupt drives the engine; otherwise it is polled
+static bool i2c_irq_mode = false;
+
+// Deadline for a transfer started now
+static uint64_t i2c_deadline() {
+    return ktime_get_ns() + I2C_TIMEOUT_US * NSEC_PER_USEC;
+}
+
+// Control register value for a transfer in the given direction
+static uint32_t i2c_control(bool read) {
+    uint32_t c = I2C_C_I2CEN | I2C_C_ST;
+    if (read) {
+        c |= I2C_C_READ;
+    }
+    if (i2c_irq_mode) {
+        c |= I2C_C_INTD | (read ? I2C_C_INTR : I2C_C_INTT);
+    }
+    return c;
+}
+
+// Feed the FIFO from the write buffer while it has room
+static void i2c_fill_fifo(i2c_xfer_t* xfer) {
+    while (xfer->tx_pos < xfer->tx_len && (*I2C_S & I2C_S_TXD)) {
+        *I2C_FIFO = xfer->tx[xfer->tx_pos++];
+    }
+}
+
+// Drain the FIFO into the read buffer
+static void i2c_drain_fifo(i2c_xfer_t* xfer) {
+    while (xfer->rx_pos < xfer->rx_len && (*I2C_S & I2C_S_RXD)) {
+        xfer->rx[xfer->rx_pos++] = (uint8_t)*I2C_FIFO;
+    }
+}
+
+// Put the transaction at the head of the queue on the bus
+static void i2c_start(i2c_xfer_t* xfer) {
+    // Clear FIFO and status
+    *I2C_C = I2C_C_I2CEN | I2C_C_CLEAR;
+    *I2C_S = I2C_S_CLEAR;
+    *I2C_A = xfer->addr;
+    
+    xfer->tx_pos = 0;
+    xfer->rx_pos = 0;
+    active_deadline = i2c_deadline();
+    
+    // A zero-length write is an address-only probe
+    if (xfer->tx_len > 0 || xfer->rx_len == 0) {
+        // The FIFO is filled once TXW shows the transfer is active, which
+        // is also when a following read can be chained
+        xfer->reading = false;
+        *I2C_DLEN = xfer->tx_len;
+        *I2C_C = i2c_control(false);
+    } else {
+        xfer->reading = true;
+        *I2C_DLEN = xfer->rx_len;
+        *I2C_C = i2c_control(true);
     }
 }
 
-// Wait for I2C transfer to complete
-static i2c_status_t i2c_wait_done() {
-    int timeout = 1000000;  // Timeout in microseconds
+// Take the head transaction off the bus with a result and start the next
+// one. Returns the finished transaction; its callback is the caller's job.
+static i2c_xfer_t* i2c_finish(i2c_status_t status) {
+    i2c_xfer_t* xfer = queue_head;
     
-    while (!(*I2C_S & I2C_S_DONE)) {
-        if (--timeout <= 0) {
-            return I2C_ERROR_TIMEOUT;
-        }
+    if (status != I2C_SUCCESS) {
+        // Abort whatever is left of the transfer
+        *I2C_C = I2C_C_I2CEN | I2C_C_CLEAR;
+    }
+    *I2C_S = I2C_S_CLEAR;
+    
+    queue_head = xfer->next;
+    if (queue_head == NULL) {
+        queue_tail = NULL;
+        *I2C_C = I2C_C_I2CEN;
+    } else {
+        i2c_start(queue_head);
+    }
+    
+    xfer->status = status;
+    return xfer;
+}
+
+// Advance the transaction on the bus. Called from the interrupt, or in a
+// loop while polled; returns a transaction that has just finished.
+static i2c_xfer_t* i2c_service(void) {
+    i2c_xfer_t* xfer = queue_head;
+    if (xfer == NULL) {
+        return NULL;
+    }
+    
+    uint32_t status = *I2C_S;
+    if (status & I2C_S_ERR) {
+        return i2c_finish(I2C_ERROR_NACK);
+    }
+    if (status & I2C_S_CLKT) {
+        return i2c_finish(I2C_ERROR_TIMEOUT);
+    }
+    
+    if (!xfer->reading) {
+        i2c_fill_fifo(xfer);
         
-        if (*I2C_S & I2C_S_ERR) {
-            return I2C_ERROR_NACK;
+        // Once the last byte is queued, start the read while the write is
+        // still active: the controller then issues a repeated start
+        // instead of a stop
+        if (xfer->tx_pos == xfer->tx_len && xfer->rx_len > 0 &&
+            (status & (I2C_S_TA | I2C_S_DONE))) {
+            xfer->reading = true;
+            *I2C_S = I2C_S_DONE;
+            *I2C_DLEN = xfer->rx_len;
+            *I2C_C = i2c_control(true);
+            return NULL;
         }
+    } else {
+        i2c_drain_fifo(xfer);
+    }
+    
+    if (!(status & I2C_S_DONE) || (xfer->rx_len > 0 && !xfer->reading)) {
+        return NULL;
+    }
+    
+    // Done: pick up what arrived after the status was sampled
+    if (xfer->reading) {
+        i2c_drain_fifo(xfer);
+    }
+    bool complete = xfer->tx_pos == xfer->tx_len && xfer->rx_pos == xfer->rx_len;
+    return i2c_finish(complete ? I2C_SUCCESS : I2C_ERROR_IO);
+}
+
+// Report a finished transaction
+static void i2c_complete(i2c_xfer_t* xfer) {
+    i2c_callback_t callback = xfer->callback;
+    void* arg = xfer->arg;
+    
+    // The caller may reuse the transaction once status is published
+    __atomic_store_n(&xfer->done, true, __ATOMIC_RELEASE);
+    if (callback) {
+        callback(xfer, arg);
+    }
+}
+
+// Poll the engine once, expiring the active transfer if it is overdue
+static void i2c_poll(void) {
+    unsigned long flags = irq_save();
+    spin_lock(&i2c_lock);
+    i2c_xfer_t* done = i2c_service();
+    if (done == NULL && queue_head != NULL && ktime_get_ns() > active_deadline) {
+        done = i2c_finish(I2C_ERROR_TIMEOUT);
+    }
+    spin_unlock(&i2c_lock);
+    irq_restore(flags);
+    
+    if (done) {
+        i2c_complete(done);
+    }
+}
+
+// BSC interrupt: TX FIFO wants data, RX FIFO wants reading, or DONE
+static void i2c_irq(uint32_t irq, void* arg) {
+    (void)irq;
+    (void)arg;
+    
+    // A completion starts the next transaction, which may need service too
+    while (1) {
+        spin_lock(&i2c_lock);
+        i2c_xfer_t* done = i2c_service();
+        spin_unlock(&i2c_lock);
         
-        if (*I2C_S & I2C_S_CLKT) {
-            return I2C_ERROR_TIMEOUT;
+        if (done == NULL) {
+            break;
         }
-        
-        delay(10);
+        i2c_complete(done);
     }
-    
-    return I2C_SUCCESS;
 }
 
 // Initialize I2C controller
@@ -94,155 +256,150 @@ i2c_status_t i2c_init(i2c_speed_t speed) {
     
     // Reset I2C controller
     *I2C_C = 0;
-    delay(100);
+    udelay(1);
     
     // Clear status
-    *I2C_S = I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
+    *I2C_S = I2C_S_CLEAR;
     
     // Set clock divider
     *I2C_DIV = divider;
     
+    // Waiters sleep until the controller reports back, so make sure
+    // there is one
+    if (*I2C_DIV != divider) {
+        uart_puts("I2C controller not responding\n");
+        return I2C_ERROR_INIT;
+    }
+    
     // Enable I2C controller
     *I2C_C = I2C_C_I2CEN;
     
+    // Completion by interrupt where the platform can deliver it
+    i2c_irq_mode = irq_register(IRQ_I2C, i2c_irq, NULL);
+    
     i2c_initialized = true;
-    uart_printf("I2C initialized at %d Hz\n", speed);
+    uart_printf("I2C initialized at %d Hz%s\n", speed, i2c_irq_mode ? "" : " (polled)");
     
     return I2C_SUCCESS;
 }
 
-// Write data to I2C device
-i2c_status_t i2c_write(uint8_t device_addr, const uint8_t* data, uint32_t len) {
+// Queue a transaction
+i2c_status_t i2c_submit(i2c_xfer_t* xfer) {
     if (!i2c_initialized) {
         return I2C_ERROR_INIT;
     }
     
-    if (data == NULL || len == 0) {
+    if (xfer == NULL || (xfer->tx == NULL && xfer->tx_len > 0) ||
+        (xfer->rx == NULL && xfer->rx_len > 0)) {
         return I2C_ERROR_PARAM;
     }
     
-    // Wait if I2C is busy
-    if (*I2C_S & I2C_S_TA) {
-        return I2C_ERROR_BUSY;
-    }
-    
-    // Clear FIFO
-    *I2C_C = I2C_C_I2CEN | I2C_C_CLEAR;
-    
-    // Clear status
-    *I2C_S = I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
+    xfer->status = I2C_PENDING;
+    xfer->done = false;
+    xfer->next = NULL;
     
-    // Set slave address
-    *I2C_A = device_addr;
+    // Fail a head transaction whose interrupt never came before queueing
+    // behind it
+    if (i2c_irq_mode) {
+        i2c_poll();
+    }
     
-    // Set data length
-    *I2C_DLEN = len;
+    unsigned long flags = irq_save();
+    spin_lock(&i2c_lock);
+    if (queue_tail != NULL) {
+        queue_tail->next = xfer;
+        queue_tail = xfer;
+    } else {
+        queue_head = queue_tail = xfer;
+        i2c_start(xfer);
+    }
+    spin_unlock(&i2c_lock);
+    irq_restore(flags);
     
-    // Fill FIFO with data (up to 16 bytes)
-    uint32_t fifo_count = (len > 16) ? 16 : len;
-    for (uint32_t i = 0; i < fifo_count; i++) {
-        *I2C_FIFO = data[i];
+    // Without an interrupt the submitter drives the bus itself
+    if (!i2c_irq_mode) {
+        while (!__atomic_load_n(&xfer->done, __ATOMIC_ACQUIRE)) {
+            i2c_poll();
+        }
     }
     
-    // Start transfer (write)
-    *I2C_C = I2C_C_I2CEN | I2C_C_ST;
+    return I2C_SUCCESS;
+}
+
+// Wake the thread waiting in i2c_transfer()
+static void i2c_wake_waiter(i2c_xfer_t* xfer, void* arg) {
+    (void)xfer;
+    thread_wake((thread_t*)arg);
+}
+
+// Run a transaction and wait for it
+static i2c_status_t i2c_transfer(uint8_t device_addr, const uint8_t* tx, uint32_t tx_len,
+                                 uint8_t* rx, uint32_t rx_len) {
+    // Sleep through the transfer if this is a thread that can be woken
+    thread_t* self = thread_current();
+    bool sleep = i2c_irq_mode && self != NULL && !irq_disabled();
+    
+    i2c_xfer_t xfer = {
+        .addr = device_addr,
+        .tx = tx,
+        .tx_len = tx_len,
+        .rx = rx,
+        .rx_len = rx_len,
+        .callback = sleep ? i2c_wake_waiter : NULL,
+        .arg = self,
+    };
+    
+    i2c_status_t status = i2c_submit(&xfer);
+    if (status != I2C_SUCCESS) {
+        return status;
+    }
     
-    // Send remaining data
-    uint32_t sent = fifo_count;
-    while (sent < len) {
-        // Wait for space in FIFO
-        while (!(*I2C_S & I2C_S_TXW)) {
-            if (*I2C_S & I2C_S_ERR) {
-                return I2C_ERROR_NACK;
-            }
-            
-            if (*I2C_S & I2C_S_CLKT) {
-                return I2C_ERROR_TIMEOUT;
-            }
-            
-            if (*I2C_S & I2C_S_DONE) {
-                break;
-            }
+    while (!__atomic_load_n(&xfer.done, __ATOMIC_ACQUIRE)) {
+        if (!sleep) {
+            i2c_poll();
+            continue;
         }
         
-        // Send data
-        *I2C_FIFO = data[sent++];
+        // Sleep until the transaction on the bus is due. If the interrupt
+        // has not finished it by then, poll, which fails it with
+        // I2C_ERROR_TIMEOUT and starts the next one.
+        uint64_t now = ktime_get_ns();
+        uint64_t deadline = __atomic_load_n(&active_deadline, __ATOMIC_RELAXED);
+        if (now <= deadline) {
+            thread_block_timeout(deadline - now);
+        } else {
+            i2c_poll();
+        }
     }
     
-    // Wait for transfer to complete
-    return i2c_wait_done();
+    return xfer.status;
 }
 
-// Read data from I2C device
-i2c_status_t i2c_read(uint8_t device_addr, uint8_t* data, uint32_t len) {
-    if (!i2c_initialized) {
-        return I2C_ERROR_INIT;
+// Write data to I2C device; a zero length probes for an acknowledge
+i2c_status_t i2c_write(uint8_t device_addr, const uint8_t* data, uint32_t len) {
+    if (data == NULL && len > 0) {
+        return I2C_ERROR_PARAM;
     }
     
+    return i2c_transfer(device_addr, data, len, NULL, 0);
+}
+
+// Read data from I2C device
+i2c_status_t i2c_read(uint8_t device_addr, uint8_t* data, uint32_t len) {
     if (data == NULL || len == 0) {
         return I2C_ERROR_PARAM;
     }
     
-    // Wait if I2C is busy
-    if (*I2C_S & I2C_S_TA) {
-        return I2C_ERROR_BUSY;
-    }
-    
-    // Clear FIFO
-    *I2C_C = I2C_C_I2CEN | I2C_C_CLEAR;
-    
-    // Clear status
-    *I2C_S = I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
-    
-    // Set slave address
-    *I2C_A = device_addr;
-    
-    // Set data length
-    *I2C_DLEN = len;
-    
-    // Start transfer (read)
-    *I2C_C = I2C_C_I2CEN | I2C_C_ST | I2C_C_READ;
-    
-    // Read data
-    uint32_t received = 0;
-    while (received < len) {
-        // Wait for data in FIFO
-        while (!(*I2C_S & I2C_S_RXD)) {
-            if (*I2C_S & I2C_S_ERR) {
-                return I2C_ERROR_NACK;
-            }
-            
-            if (*I2C_S & I2C_S_CLKT) {
-                return I2C_ERROR_TIMEOUT;
-            }
-            
-            if (*I2C_S & I2C_S_DONE) {
-                break;
-            }
-        }
-        
-        // Read data
-        data[received++] = *I2C_FIFO;
-    }
-    
-    // Wait for transfer to complete
-    return i2c_wait_done();
+    return i2c_transfer(device_addr, NULL, 0, data, len);
 }
 
-// Write register and then read data from I2C device
+// Write register and then read data from I2C device, joined by a repeated start
 i2c_status_t i2c_write_read(uint8_t device_addr, const uint8_t* write_data, uint32_t write_len, uint8_t* read_data, uint32_t read_len) {
-    i2c_status_t status;
-    
-    // Write data
-    status = i2c_write(device_addr, write_data, write_len);
-    if (status != I2C_SUCCESS) {
-        return status;
+    if (write_data == NULL || write_len == 0 || read_data == NULL || read_len == 0) {
+        return I2C_ERROR_PARAM;
     }
     
-    // Read data
-    status = i2c_read(device_addr, read_data, read_len);
-    
-    return status;
+    return i2c_transfer(device_addr, write_data, write_len, read_data, read_len);
 }
 
 // Write register to I2C device
@@ -253,18 +410,7 @@ i2c_status_t i2c_write_reg(uint8_t device_addr, uint8_t reg, uint8_t value) {
 
 // Read register from I2C device
 i2c_status_t i2c_read_reg(uint8_t device_addr, uint8_t reg, uint8_t* value) {
-    i2c_status_t status;
-    
-    // Write register address
-    status = i2c_write(device_addr, &reg, 1);
-    if (status != I2C_SUCCESS) {
-        return status;
-    }
-    
-    // Read register value
-    status = i2c_read(device_addr, value, 1);
-    
-    return status;
+    return i2c_write_read(device_addr, &reg, 1, value, 1);
 }
 
 // Scan I2C bus for devices
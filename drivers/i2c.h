@@ -10,6 +10,7 @@
 #define I2C_H
 
 #include "types.h"
+#include <stdbool.h>
 
 // I2C status codes
 typedef enum {
@@ -18,7 +19,9 @@ typedef enum {
     I2C_ERROR_BUSY = -2,
     I2C_ERROR_NACK = -3,
     I2C_ERROR_TIMEOUT = -4,
-    I2C_ERROR_PARAM = -5
+    I2C_ERROR_PARAM = -5,
+    I2C_ERROR_IO = -6,          // Transfer ended before all bytes moved
+    I2C_PENDING = 1             // Submitted and not yet complete
 } i2c_status_t;
 
 // I2C bus speed
@@ -28,16 +31,53 @@ typedef enum {
     I2C_SPEED_FAST_PLUS = 1000000 // 1 MHz
 } i2c_speed_t;
 
+typedef struct i2c_xfer i2c_xfer_t;
+
+// Called when a submitted transaction completes, from interrupt context
+// when the controller is interrupt driven
+typedef void (*i2c_callback_t)(i2c_xfer_t* xfer, void* arg);
+
+// One bus transaction: tx_len bytes are written, then rx_len bytes are
+// read after a repeated start. Either part may be empty; both empty
+// probes the address. The caller owns the memory until done is set.
+struct i2c_xfer {
+    uint8_t addr;
+    const uint8_t* tx;
+    uint32_t tx_len;
+    uint8_t* rx;
+    uint32_t rx_len;
+    i2c_callback_t callback;    // Optional
+    void* arg;
+    
+    // Filled in by the driver
+    volatile i2c_status_t status;
+    volatile bool done;
+    bool reading;
+    uint32_t tx_pos;
+    uint32_t rx_pos;
+    i2c_xfer_t* next;
+};
+
 // Initialize I2C controller
 i2c_status_t i2c_init(i2c_speed_t speed);
 
-// Write data to I2C device
+// Queue a transaction and return at once; transactions run in submission
+// order and finish through their callback. Without an I2C interrupt the
+// transaction completes before this returns. A transaction the controller
+// never finishes fails with I2C_ERROR_TIMEOUT once a waiter or the next
+// submission finds it overdue.
+i2c_status_t i2c_submit(i2c_xfer_t* xfer);
+
+// The calls below submit a transaction and wait for it, sleeping when
+// called from a thread with interrupts enabled
+
+// Write data to I2C device; a zero length probes for an acknowledge
 i2c_status_t i2c_write(uint8_t device_addr, const uint8_t* data, uint32_t len);
 
 // Read data from I2C device
 i2c_status_t i2c_read(uint8_t device_addr, uint8_t* data, uint32_t len);
 
-// Write register and then read data from I2C device
+// Write register and then read data from I2C device, joined by a repeated start
 i2c_status_t i2c_write_read(uint8_t device_addr, const uint8_t* write_data, uint32_t write_len, uint8_t* read_data, uint32_t read_len);
 
 // Write register to I2C device
@@ -0,0 +1,198 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ *
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "intc.h"
+#include "../kernel/smp.h"
+
+#if defined(__aarch64__) && defined(INTC_GIC400)
+
+// GIC-400 on the Raspberry Pi 4
+#define GIC_BASE            0xFF840000UL
+#define GICD_BASE           (GIC_BASE + 0x1000)
+#define GICC_BASE           (GIC_BASE + 0x2000)
+
+#define GICD_CTLR           ((volatile uint32_t*)(GICD_BASE + 0x000))
+#define GICD_TYPER          ((volatile uint32_t*)(GICD_BASE + 0x004))
+#define GICD_ISENABLER(n)   ((volatile uint32_t*)(GICD_BASE + 0x100 + 4 * (n)))
+#define GICD_ICENABLER(n)   ((volatile uint32_t*)(GICD_BASE + 0x180 + 4 * (n)))
+#define GICD_IPRIORITYR(n)  ((volatile uint8_t*)(GICD_BASE + 0x400 + (n)))
+#define GICD_ITARGETSR(n)   ((volatile uint8_t*)(GICD_BASE + 0x800 + (n)))
+#define GICD_ICFGR(n)       ((volatile uint32_t*)(GICD_BASE + 0xC00 + 4 * (n)))
+
+#define GICC_CTLR           ((volatile uint32_t*)(GICC_BASE + 0x000))
+#define GICC_PMR            ((volatile uint32_t*)(GICC_BASE + 0x004))
+#define GICC_IAR            ((volatile uint32_t*)(GICC_BASE + 0x00C))
+#define GICC_EOIR           ((volatile uint32_t*)(GICC_BASE + 0x010))
+
+#define GIC_SPURIOUS        1020
+#define GIC_PRIORITY        0xA0
+
+void intc_init(void) {
+    *GICD_CTLR = 0;
+
+    uint32_t lines = ((*GICD_TYPER & 0x1F) + 1) * 32;
+    if (lines > NR_IRQS) {
+        lines = NR_IRQS;
+    }
+
+    // Shared interrupts: masked, level triggered, routed to core 0
+    for (uint32_t irq = 32; irq < lines; irq += 32) {
+        *GICD_ICENABLER(irq / 32) = 0xFFFFFFFF;
+    }
+    for (uint32_t irq = 32; irq < lines; irq += 16) {
+        *GICD_ICFGR(irq / 16) = 0;
+    }
+    for (uint32_t irq = 32; irq < lines; irq++) {
+        *GICD_IPRIORITYR(irq) = GIC_PRIORITY;
+        *GICD_ITARGETSR(irq) = 1;
+    }
+
+    *GICD_CTLR = 1;
+}
+
+void intc_init_cpu(void) {
+    // Banked SGIs and PPIs start masked
+    *GICD_ICENABLER(0) = 0xFFFFFFFF;
+    for (uint32_t irq = 0; irq < 32; irq++) {
+        *GICD_IPRIORITYR(irq) = GIC_PRIORITY;
+    }
+
+    *GICC_PMR = 0xF0;
+    *GICC_CTLR = 1;
+}
+
+void intc_enable(uint32_t irq) {
+    if (irq < NR_IRQS) {
+        *GICD_ISENABLER(irq / 32) = 1U << (irq % 32);
+    }
+}
+
+void intc_disable(uint32_t irq) {
+    if (irq < NR_IRQS) {
+        *GICD_ICENABLER(irq / 32) = 1U << (irq % 32);
+    }
+}
+
+uint32_t intc_next_pending(void) {
+    uint32_t irq = *GICC_IAR & 0x3FF;
+    return irq >= GIC_SPURIOUS ? INTC_NONE : irq;
+}
+
+void intc_eoi(uint32_t irq) {
+    *GICC_EOIR = irq;
+}
+
+#elif defined(__aarch64__)
+
+// BCM2835 ARMCTRL: GPU peripheral interrupts, delivered to core 0
+#define ARMCTRL_BASE        0x3F00B200UL
+#define IRQ_PENDING_1       ((volatile uint32_t*)(ARMCTRL_BASE + 0x04))
+#define IRQ_PENDING_2       ((volatile uint32_t*)(ARMCTRL_BASE + 0x08))
+#define IRQ_ENABLE_1        ((volatile uint32_t*)(ARMCTRL_BASE + 0x10))
+#define IRQ_ENABLE_2        ((volatile uint32_t*)(ARMCTRL_BASE + 0x14))
+#define IRQ_DISABLE_1       ((volatile uint32_t*)(ARMCTRL_BASE + 0x1C))
+#define IRQ_DISABLE_2       ((volatile uint32_t*)(ARMCTRL_BASE + 0x20))
+
+// BCM2836 local peripherals: per-core timer routing and IRQ sources
+#define LOCAL_BASE                  0x40000000UL
+#define LOCAL_GPU_INT_ROUTING       ((volatile uint32_t*)(LOCAL_BASE + 0x0C))
+#define LOCAL_TIMER_INT_CTRL(cpu)   ((volatile uint32_t*)(LOCAL_BASE + 0x40 + 4 * (cpu)))
+#define LOCAL_IRQ_SOURCE(cpu)       ((volatile uint32_t*)(LOCAL_BASE + 0x60 + 4 * (cpu)))
+#define LOCAL_SOURCE_GPU            (1U << 8)
+#define LOCAL_SOURCE_MASK           0xFFU
+
+void intc_init(void) {
+    *IRQ_DISABLE_1 = 0xFFFFFFFF;
+    *IRQ_DISABLE_2 = 0xFFFFFFFF;
+
+    // GPU interrupts go to core 0 IRQ
+    *LOCAL_GPU_INT_ROUTING = 0;
+}
+
+void intc_init_cpu(void) {
+    *LOCAL_TIMER_INT_CTRL(smp_processor_id()) = 0;
+}
+
+void intc_enable(uint32_t irq) {
+    if (irq >= IRQ_LOCAL_BASE) {
+        // Only the four generic timer sources are routable per core
+        if (irq - IRQ_LOCAL_BASE < 4) {
+            *LOCAL_TIMER_INT_CTRL(smp_processor_id()) |= 1U << (irq - IRQ_LOCAL_BASE);
+        }
+    } else if (irq < 32) {
+        *IRQ_ENABLE_1 = 1U << irq;
+    } else {
+        *IRQ_ENABLE_2 = 1U << (irq - 32);
+    }
+}
+
+void intc_disable(uint32_t irq) {
+    if (irq >= IRQ_LOCAL_BASE) {
+        if (irq - IRQ_LOCAL_BASE < 4) {
+            *LOCAL_TIMER_INT_CTRL(smp_processor_id()) &= ~(1U << (irq - IRQ_LOCAL_BASE));
+        }
+    } else if (irq < 32) {
+        *IRQ_DISABLE_1 = 1U << irq;
+    } else {
+        *IRQ_DISABLE_2 = 1U << (irq - 32);
+    }
+}
+
+uint32_t intc_next_pending(void) {
+    uint32_t source = *LOCAL_IRQ_SOURCE(smp_processor_id());
+
+    // Local sources other than the GPU line, lowest first
+    uint32_t local = source & LOCAL_SOURCE_MASK;
+    if (local) {
+        return IRQ_LOCAL_BASE + __builtin_ctz(local);
+    }
+
+    if (source & LOCAL_SOURCE_GPU) {
+        uint32_t pending = *IRQ_PENDING_1;
+        if (pending) {
+            return __builtin_ctz(pending);
+        }
+        pending = *IRQ_PENDING_2;
+        if (pending) {
+            return 32 + __builtin_ctz(pending);
+        }
+    }
+
+    return INTC_NONE;
+}
+
+void intc_eoi(uint32_t irq) {
+    // Level triggered; the device handler clears the source
+    (void)irq;
+}
+
+#else
+
+void intc_init(void) {
+}
+
+void intc_init_cpu(void) {
+}
+
+void intc_enable(uint32_t irq) {
+    (void)irq;
+}
+
+void intc_disable(uint32_t irq) {
+    (void)irq;
+}
+
+uint32_t intc_next_pending(void) {
+    return INTC_NONE;
+}
+
+void intc_eoi(uint32_t irq) {
+    (void)irq;
+}
+
+#endif
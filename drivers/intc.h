@@ -0,0 +1,56 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ *
+ * ───────────────────────────────────────────────────────────────────────────── */
+#ifndef INTC_H
+#define INTC_H
+
+#include "types.h"
+
+// The interrupt controller is selected at build time:
+//   default          BCM2836 per-core local controller + BCM2835 ARMCTRL
+//                    (Raspberry Pi 3, QEMU raspi3b)
+//   -DINTC_GIC400    ARM GIC-400 (Raspberry Pi 4)
+//
+// IRQ numbers are controller specific; drivers use the names below.
+#if defined(INTC_GIC400)
+#define NR_IRQS             256
+#define IRQ_TIMER           30              // PPI: EL1 physical timer
+#define IRQ_UART0           (32 + 121)      // SPI: PL011 UART0
+#define IRQ_DMA(n)          (32 + 80 + (n)) // SPI: DMA channels 0-10
+#define IRQ_I2C             (32 + 117)      // SPI: BSC controllers
+#else
+// 0-63 are ARMCTRL GPU interrupts, 64+ the per-core local sources
+#define NR_IRQS             96
+#define IRQ_LOCAL_BASE      64
+#define IRQ_TIMER           (IRQ_LOCAL_BASE + 1)    // CNTPNSIRQ
+#define IRQ_UART0           57
+#define IRQ_DMA(n)          (16 + (n))      // DMA channels 0-10
+#define IRQ_I2C             53              // BSC controllers
+#endif
+
+// Returned by intc_next_pending() when nothing is pending
+#define INTC_NONE           0xFFFFFFFFU
+
+// Set up the distributor / shared state; boot core only
+void intc_init(void);
+
+// Set up the calling core's interface
+void intc_init_cpu(void);
+
+// Unmask and mask an interrupt. Per-core interrupts (the timer) are only
+// affected on the calling core.
+void intc_enable(uint32_t irq);
+void intc_disable(uint32_t irq);
+
+// Acknowledge and return the highest priority pending interrupt
+uint32_t intc_next_pending(void);
+
+// Signal the end of handling for an interrupt from intc_next_pending()
+void intc_eoi(uint32_t irq);
+
+#endif // INTC_H
@@ -8,6 +8,14 @@
  * ───────────────────────────────────────────────────────────────────────────── */
 #include "spi.h"
 #include "uart.h"
+#include "dma.h"
+#include "../kernel/dma_pool.h"
+#include "../kernel/irq.h"
+#include "../kernel/memory.h"
+#include "../kernel/mutex.h"
+#include "../kernel/sched.h"
+#include "../kernel/stdio.h"
+#include "../kernel/timer.h"
 #include <stdbool.h>
 
 // Raspberry Pi 5 SPI registers
@@ -50,27 +58,66 @@
 // SPI clock divider
 #define SPI_CLOCK_FREQ      250000000  // 250 MHz
 
+// Longest a transfer may take to complete
+#define SPI_TIMEOUT_US      1000000
+
+// FIFO depth in bytes, and the RX fill level at which RXR is raised
+#define SPI_FIFO_SIZE       64
+#define SPI_FIFO_RXR_LEVEL  48
+
+// DMA channels for the FIFO; both have their own interrupt line
+#define SPI_DMA_TX_CHANNEL  4
+#define SPI_DMA_RX_CHANNEL  5
+
+// Transfers shorter than this are cheaper to run by PIO
+#define SPI_DMA_THRESHOLD   256
+
+// Longest run DLEN can count, kept a multiple of the 4-byte FIFO word
+#define SPI_DMA_CHUNK       65532
+
 // Static variables
 static bool spi_initialized = false;
 static spi_config_t current_config;
 
-// Delay function - simple busy wait
-static void delay(int32_t count) {
-    while (count--) {
-        asm volatile("nop");
-    }
-}
+// Held for a whole transfer, and while the configuration changes; DMA
+// callers sleep mid-transfer, so other threads must queue behind them
+static mutex_t spi_bus_lock = MUTEX_INIT;
+
+// CS register value between transfers (mode, polarity and chip select),
+// so the transfer path never has to read-modify-write SPI_CS
+static uint32_t spi_cs_config;
+
+// DMA state, used once both channels have been claimed by spi_init()
+typedef struct {
+    dma_cb_t* tx;               // First TX control block of the chunk
+    dma_cb_t* rx;               // First RX control block of the chunk
+    uint32_t len;               // Bytes in the chunk, loaded into DLEN
+} spi_dma_chunk_t;
+
+static bool spi_dma_ready = false;
+static struct {
+    spi_dma_chunk_t* chunks;
+    uint32_t num_chunks;
+    uint32_t next_chunk;
+    spi_status_t status;
+    thread_t* waiter;
+    bool complete;
+    spinlock_t lock;            // Completion interrupt against the timeout
+} spi_dma;
+
+// Source for the zeros clocked out by segments without TX data
+static const uint32_t spi_dma_zero __attribute__((aligned(64))) = 0;
+
+static void spi_dma_done(uint32_t channel, bool error, void* arg);
 
 // Wait for SPI transfer to complete
 static spi_status_t spi_wait_done() {
-    int timeout = 1000000;  // Timeout in microseconds
+    uint64_t deadline = ktime_get_ns() + SPI_TIMEOUT_US * NSEC_PER_USEC;
     
     while (!(*SPI_CS & SPI_CS_DONE)) {
-        if (--timeout <= 0) {
+        if (ktime_get_ns() > deadline) {
             return SPI_ERROR_TIMEOUT;
         }
-        
-        delay(10);
     }
     
     return SPI_SUCCESS;
@@ -91,7 +138,7 @@ spi_status_t spi_init(const spi_config_t* config) {
     
     // Reset SPI controller
     *SPI_CS = 0;
-    delay(100);
+    udelay(1);
     
     // Clear FIFOs
     *SPI_CS = SPI_CS_CLEAR_RX | SPI_CS_CLEAR_TX;
@@ -123,6 +170,7 @@ spi_status_t spi_init(const spi_config_t* config) {
     
     // Apply configuration
     *SPI_CS = cs_reg;
+    spi_cs_config = cs_reg;
     
     // Save configuration
     current_config = *config;
@@ -130,184 +178,524 @@ spi_status_t spi_init(const spi_config_t* config) {
     spi_initialized = true;
     uart_printf("SPI initialized at %d Hz\n", config->clock_speed);
     
+    // Bulk transfers go through DMA when both channels are available
+    if (!spi_dma_ready) {
+        if (dma_channel_request(SPI_DMA_RX_CHANNEL, spi_dma_done, NULL)) {
+            if (dma_channel_request(SPI_DMA_TX_CHANNEL, spi_dma_done, NULL)) {
+                spi_dma_ready = true;
+            } else {
+                dma_channel_release(SPI_DMA_RX_CHANNEL);
+            }
+        }
+        if (!spi_dma_ready) {
+            uart_puts("SPI: DMA unavailable, using PIO\n");
+        }
+    }
+    
     return SPI_SUCCESS;
 }
 
-// Transfer data over SPI (simultaneous read/write)
-spi_status_t spi_transfer(const uint8_t* tx_data, uint8_t* rx_data, uint32_t len) {
-    if (!spi_initialized) {
-        return SPI_ERROR_INIT;
+// Walks the tx or rx side of a segment list
+typedef struct {
+    const spi_segment_t* seg;
+    uint32_t offset;
+} spi_cursor_t;
+
+// Feed n bytes from the cursor into the TX FIFO; NULL tx buffers send zeros
+static void spi_push(spi_cursor_t* c, uint32_t n) {
+    while (n > 0) {
+        uint32_t chunk = c->seg->len - c->offset;
+        if (chunk == 0) {
+            c->seg++;
+            c->offset = 0;
+            continue;
+        }
+        if (chunk > n) {
+            chunk = n;
+        }
+
+        const uint8_t* tx = c->seg->tx;
+        if (tx != NULL) {
+            tx += c->offset;
+            for (uint32_t i = 0; i < chunk; i++) {
+                *SPI_FIFO = tx[i];
+            }
+        } else {
+            for (uint32_t i = 0; i < chunk; i++) {
+                *SPI_FIFO = 0;
+            }
+        }
+
+        c->offset += chunk;
+        n -= chunk;
     }
-    
-    if (tx_data == NULL || rx_data == NULL || len == 0) {
-        return SPI_ERROR_PARAM;
+}
+
+// Drain n bytes from the RX FIFO into the cursor; NULL rx buffers discard
+static void spi_pull(spi_cursor_t* c, uint32_t n) {
+    while (n > 0) {
+        uint32_t chunk = c->seg->len - c->offset;
+        if (chunk == 0) {
+            c->seg++;
+            c->offset = 0;
+            continue;
+        }
+        if (chunk > n) {
+            chunk = n;
+        }
+
+        uint8_t* rx = c->seg->rx;
+        if (rx != NULL) {
+            rx += c->offset;
+            for (uint32_t i = 0; i < chunk; i++) {
+                rx[i] = (uint8_t)*SPI_FIFO;
+            }
+        } else {
+            for (uint32_t i = 0; i < chunk; i++) {
+                (void)*SPI_FIFO;
+            }
+        }
+
+        c->offset += chunk;
+        n -= chunk;
     }
-    
-    // Wait if SPI is busy
-    if (*SPI_CS & SPI_CS_TA) {
-        return SPI_ERROR_BUSY;
+}
+
+// PIO transfer of a segment list.
+//
+// Never more than SPI_FIFO_SIZE bytes are in flight, so the TX FIFO
+// cannot overflow and every byte written is guaranteed a slot in the RX
+// FIFO. That lets whole bursts move without polling TXD/RXD per byte:
+// the FIFO is prefilled, and each time RXR reports it 3/4 full those
+// bytes are drained and the same number refilled in one go.
+//
+// The timeout bounds a stall, not the whole transfer: every burst that
+// arrives pushes the deadline SPI_TIMEOUT_US further out.
+static spi_status_t spi_transfer_pio(const spi_segment_t* segs, uint32_t total) {
+    // Clear FIFOs and start the transfer
+    *SPI_CS = spi_cs_config | SPI_CS_CLEAR_RX | SPI_CS_CLEAR_TX | SPI_CS_TA;
+    
+    spi_cursor_t tx = { segs, 0 };
+    spi_cursor_t rx = { segs, 0 };
+    uint32_t tx_left = total;
+    uint32_t rx_left = total;
+    spi_status_t status = SPI_SUCCESS;
+    
+    // Prefill the FIFO
+    uint32_t burst = tx_left < SPI_FIFO_SIZE ? tx_left : SPI_FIFO_SIZE;
+    spi_push(&tx, burst);
+    tx_left -= burst;
+    
+    uint64_t deadline = ktime_get_ns() + SPI_TIMEOUT_US * NSEC_PER_USEC;
+    while (rx_left > 0) {
+        uint32_t cs = *SPI_CS;
+        uint32_t n;
+        
+        if ((cs & SPI_CS_RXR) && rx_left >= SPI_FIFO_RXR_LEVEL) {
+            n = SPI_FIFO_RXR_LEVEL;
+        } else if (cs & SPI_CS_RXD) {
+            n = 1;
+        } else {
+            if (ktime_get_ns() > deadline) {
+                status = SPI_ERROR_TIMEOUT;
+                break;
+            }
+            continue;
+        }
+        
+        spi_pull(&rx, n);
+        rx_left -= n;
+        deadline = ktime_get_ns() + SPI_TIMEOUT_US * NSEC_PER_USEC;
+        
+        // Refill the slots just freed
+        if (n > tx_left) {
+            n = tx_left;
+        }
+        spi_push(&tx, n);
+        tx_left -= n;
     }
     
-    // Clear FIFOs
-    *SPI_CS = *SPI_CS | SPI_CS_CLEAR_RX | SPI_CS_CLEAR_TX;
+    // Wait for the last bit to clock out
+    if (status == SPI_SUCCESS) {
+        status = spi_wait_done();
+    }
     
-    // Set data length
-    *SPI_DLEN = len;
+    // End transfer
+    *SPI_CS = spi_cs_config;
     
-    // Start transfer
-    *SPI_CS = *SPI_CS | SPI_CS_TA;
+    return status;
+}
+
+// Whether an RX buffer must be received through a bounce buffer from the
+// DMA pool rather than in place
+static bool spi_dma_bounced(const spi_segment_t* seg) {
+    return seg->rx != NULL && !dma_rx_safe(seg->rx, seg->len);
+}
+
+// Whether a transfer can go through DMA: large enough to pay for the
+// setup, called from a thread that can sleep, and made of word-aligned
+// buffers in DMA-visible RAM. The 32-bit FIFO accesses pack four bytes
+// per word, so only the last segment may end mid-word.
+//
+// RX buffers must also own every cache line they touch (dma_rx_safe()).
+// Syncing one invalidates whole lines, which would throw away another
+// core's writes to neighbouring data, and an early eviction would write
+// stale bytes over the received ones. RX segments that fail this but fit
+// in a DMA pool buffer are bounced; larger ones keep the transfer on PIO.
+static bool spi_dma_eligible(const spi_segment_t* segs, uint32_t count, uint32_t total) {
+    if (!spi_dma_ready || total < SPI_DMA_THRESHOLD ||
+        thread_current() == NULL || irq_disabled()) {
+        return false;
+    }
     
-    // Transfer data
-    uint32_t count = 0;
-    while (count < len) {
-        // Write data if FIFO has space
-        if ((*SPI_CS & SPI_CS_TXD) && count < len) {
-            *SPI_FIFO = tx_data[count];
-            count++;
+    for (uint32_t i = 0; i < count; i++) {
+        const spi_segment_t* seg = &segs[i];
+        if (i + 1 < count && (seg->len & 3) != 0) {
+            return false;
         }
-        
-        // Read data if FIFO has data
-        if (*SPI_CS & SPI_CS_RXD) {
-            rx_data[count - 1] = *SPI_FIFO;
+        if (seg->tx != NULL &&
+            (((uintptr_t)seg->tx & 3) != 0 || !dma_addressable(seg->tx, seg->len))) {
+            return false;
+        }
+        if (spi_dma_bounced(seg) && seg->len > DMA_BUF_MAX_SIZE) {
+            return false;
         }
     }
     
-    // Wait for transfer to complete
-    spi_status_t status = spi_wait_done();
+    return true;
+}
+
+// Start the next DLEN-sized chunk of the DMA transfer. TA stays set from
+// one chunk to the next, so CS is held for the whole transfer.
+static void spi_dma_start_chunk(void) {
+    spi_dma_chunk_t* chunk = &spi_dma.chunks[spi_dma.next_chunk++];
+    
+    *SPI_DLEN = chunk->len;
+    dma_start(SPI_DMA_RX_CHANNEL, chunk->rx);
+    dma_start(SPI_DMA_TX_CHANNEL, chunk->tx);
+}
+
+// Channel interrupt: the RX chain of a chunk has completed, or either
+// channel stopped on an error
+static void spi_dma_done(uint32_t channel, bool error, void* arg) {
+    (void)arg;
+    
+    spin_lock(&spi_dma.lock);
     
-    // Read any remaining data from FIFO
-    while (*SPI_CS & SPI_CS_RXD) {
-        rx_data[count - 1] = *SPI_FIFO;
-        count++;
+    // The waiter may have timed out and aborted the transfer already
+    if (spi_dma.complete) {
+        spin_unlock(&spi_dma.lock);
+        return;
     }
     
-    // End transfer
-    *SPI_CS = *SPI_CS & ~SPI_CS_TA;
+    if (!error) {
+        if (channel != SPI_DMA_RX_CHANNEL) {
+            spin_unlock(&spi_dma.lock);
+            return;
+        }
+        if (spi_dma.next_chunk < spi_dma.num_chunks) {
+            spi_dma_start_chunk();
+            spin_unlock(&spi_dma.lock);
+            return;
+        }
+    } else {
+        dma_abort(SPI_DMA_TX_CHANNEL);
+        dma_abort(SPI_DMA_RX_CHANNEL);
+        spi_dma.status = SPI_ERROR_DMA;
+    }
     
-    return status;
+    thread_t* waiter = spi_dma.waiter;
+    __atomic_store_n(&spi_dma.complete, true, __ATOMIC_RELEASE);
+    spin_unlock(&spi_dma.lock);
+    thread_wake(waiter);
 }
 
-// Write data over SPI (ignore received data)
-spi_status_t spi_write(const uint8_t* tx_data, uint32_t len) {
-    if (!spi_initialized) {
-        return SPI_ERROR_INIT;
+// Longest a DMA transfer may take: its time on the wire at the configured
+// clock, plus SPI_TIMEOUT_US for a stalled or slow start
+static uint64_t spi_dma_timeout_ns(uint32_t total) {
+    uint64_t wire = (uint64_t)total * 8 * NSEC_PER_SEC / current_config.clock_speed;
+    return wire + (uint64_t)SPI_TIMEOUT_US * NSEC_PER_USEC;
+}
+
+// Fill one TX and one RX control block for a piece of a segment
+static void spi_dma_fill_cbs(dma_cb_t* tx, dma_cb_t* rx, const uint8_t* tx_buf, uint8_t* rx_buf,
+                             uint32_t offset, uint32_t len) {
+    tx->ti = DMA_TI_DEST_DREQ | DMA_TI_PERMAP(DMA_DREQ_SPI0_TX) | DMA_TI_WAIT_RESP;
+    tx->dest_ad = dma_periph_addr(SPI_FIFO);
+    tx->txfr_len = len;
+    tx->stride = 0;
+    tx->nextconbk = 0;
+    if (tx_buf != NULL) {
+        tx->ti |= DMA_TI_SRC_INC;
+        tx->source_ad = dma_bus_addr(tx_buf + offset);
+    } else {
+        tx->source_ad = dma_bus_addr(&spi_dma_zero);
     }
     
-    if (tx_data == NULL || len == 0) {
-        return SPI_ERROR_PARAM;
+    rx->ti = DMA_TI_SRC_DREQ | DMA_TI_PERMAP(DMA_DREQ_SPI0_RX) | DMA_TI_WAIT_RESP;
+    rx->source_ad = dma_periph_addr(SPI_FIFO);
+    rx->txfr_len = len;
+    rx->stride = 0;
+    rx->nextconbk = 0;
+    if (rx_buf != NULL) {
+        rx->ti |= DMA_TI_DEST_INC;
+        rx->dest_ad = dma_bus_addr(rx_buf + offset);
+    } else {
+        rx->ti |= DMA_TI_DEST_IGNORE;
+        rx->dest_ad = 0;
     }
-    
-    // Wait if SPI is busy
-    if (*SPI_CS & SPI_CS_TA) {
-        return SPI_ERROR_BUSY;
+}
+
+// DMA transfer of a segment list.
+//
+// The list is cut into chunks of at most SPI_DMA_CHUNK bytes, the most
+// DLEN can count. Each chunk gets a TX and an RX control-block chain with
+// one block per segment piece; the RX chain ends with an interrupt that
+// starts the next chunk, so the CPU only steps in once per 64 KB. The
+// caller sleeps until the last chunk completes, or aborts both channels
+// if the completion never comes. RX segments that cannot receive in place
+// land in DMA pool buffers and are copied out afterwards.
+static spi_status_t spi_transfer_dma(const spi_segment_t* segs, uint32_t count, uint32_t total) {
+    uint32_t num_chunks = (total + SPI_DMA_CHUNK - 1) / SPI_DMA_CHUNK;
+    uint32_t max_pieces = count + num_chunks;
+    size_t cb_bytes = (size_t)max_pieces * 2 * sizeof(dma_cb_t);
+    size_t chunk_bytes = (size_t)num_chunks * sizeof(spi_dma_chunk_t);
+    size_t bytes = cb_bytes + chunk_bytes + (size_t)count * sizeof(uint8_t*);
+    
+    // Chains for up to a few hundred pieces come from the DMA pool;
+    // only multi-megabyte transfers need pages of their own
+    void* block = dma_buf_alloc(bytes);
+    bool pooled = block != NULL;
+    if (!pooled) {
+        block = page_alloc(page_order_for_size(bytes));
+        if (block == NULL || !dma_addressable(block, bytes)) {
+            // Not worth failing the transfer over
+            page_free(block);
+            return spi_transfer_pio(segs, total);
+        }
+    }
+    dma_cb_t* tx_cbs = (dma_cb_t*)block;
+    dma_cb_t* rx_cbs = tx_cbs + max_pieces;
+    spi_dma_chunk_t* chunks = (spi_dma_chunk_t*)((uint8_t*)block + cb_bytes);
+    uint8_t** rx_bufs = (uint8_t**)((uint8_t*)block + cb_bytes + chunk_bytes);
+    
+    // Where each segment receives
+    for (uint32_t i = 0; i < count; i++) {
+        rx_bufs[i] = segs[i].rx;
+        if (!spi_dma_bounced(&segs[i])) {
+            continue;
+        }
+        rx_bufs[i] = (uint8_t*)dma_buf_alloc(segs[i].len);
+        if (rx_bufs[i] == NULL) {
+            // Pool exhausted: release what was taken and fall back to PIO
+            for (uint32_t j = 0; j < i; j++) {
+                if (rx_bufs[j] != segs[j].rx) {
+                    dma_buf_free(rx_bufs[j]);
+                }
+            }
+            if (pooled) {
+                dma_buf_free(block);
+            } else {
+                page_free(block);
+            }
+            return spi_transfer_pio(segs, total);
+        }
     }
     
-    // Clear FIFOs
-    *SPI_CS = *SPI_CS | SPI_CS_CLEAR_RX | SPI_CS_CLEAR_TX;
-    
-    // Set data length
-    *SPI_DLEN = len;
+    // Build the chains, splitting segments at chunk boundaries
+    uint32_t pieces = 0;
+    uint32_t chunk = 0;
+    uint32_t chunk_left = 0;
+    dma_cb_t* prev_tx = NULL;
+    dma_cb_t* prev_rx = NULL;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t offset = 0;
+        while (offset < segs[i].len) {
+            if (chunk_left == 0) {
+                // Close the previous chunk and open a new one
+                if (prev_rx != NULL) {
+                    prev_rx->ti |= DMA_TI_INTEN;
+                }
+                uint32_t remaining = total - chunk * SPI_DMA_CHUNK;
+                chunk_left = remaining < SPI_DMA_CHUNK ? remaining : SPI_DMA_CHUNK;
+                chunks[chunk].tx = &tx_cbs[pieces];
+                chunks[chunk].rx = &rx_cbs[pieces];
+                chunks[chunk].len = chunk_left;
+                chunk++;
+                prev_tx = NULL;
+                prev_rx = NULL;
+            }
+            
+            uint32_t len = segs[i].len - offset;
+            if (len > chunk_left) {
+                len = chunk_left;
+            }
+            
+            dma_cb_t* tx = &tx_cbs[pieces];
+            dma_cb_t* rx = &rx_cbs[pieces];
+            pieces++;
+            spi_dma_fill_cbs(tx, rx, segs[i].tx, rx_bufs[i], offset, len);
+            if (prev_tx != NULL) {
+                prev_tx->nextconbk = dma_bus_addr(tx);
+                prev_rx->nextconbk = dma_bus_addr(rx);
+            }
+            prev_tx = tx;
+            prev_rx = rx;
+            
+            offset += len;
+            chunk_left -= len;
+        }
+    }
+    prev_rx->ti |= DMA_TI_INTEN;
     
-    // Start transfer
-    *SPI_CS = *SPI_CS | SPI_CS_TA;
+    // Make the chains and buffers visible to the engine
+    dma_sync_for_device(tx_cbs, (size_t)max_pieces * 2 * sizeof(dma_cb_t), DMA_TO_DEVICE);
+    for (uint32_t i = 0; i < count; i++) {
+        if (segs[i].tx != NULL) {
+            dma_sync_for_device(segs[i].tx, segs[i].len, DMA_TO_DEVICE);
+        }
+        if (rx_bufs[i] != NULL) {
+            dma_sync_for_device(rx_bufs[i], segs[i].len, DMA_FROM_DEVICE);
+        }
+    }
     
-    // Write data
-    uint32_t count = 0;
-    while (count < len) {
-        // Write data if FIFO has space
-        if ((*SPI_CS & SPI_CS_TXD) && count < len) {
-            *SPI_FIFO = tx_data[count];
-            count++;
+    spi_dma.chunks = chunks;
+    spi_dma.num_chunks = num_chunks;
+    spi_dma.next_chunk = 0;
+    spi_dma.status = SPI_SUCCESS;
+    spi_dma.waiter = thread_current();
+    spi_dma.complete = false;
+    
+    // Clear FIFOs, then hand the FIFO to the DMA engine
+    *SPI_CS = spi_cs_config | SPI_CS_CLEAR_RX | SPI_CS_CLEAR_TX;
+    *SPI_CS = spi_cs_config | SPI_CS_DMAEN | SPI_CS_TA;
+    
+    unsigned long flags = irq_save();
+    spin_lock(&spi_dma.lock);
+    spi_dma_start_chunk();
+    spin_unlock(&spi_dma.lock);
+    irq_restore(flags);
+    
+    uint64_t deadline = ktime_get_ns() + spi_dma_timeout_ns(total);
+    while (!__atomic_load_n(&spi_dma.complete, __ATOMIC_ACQUIRE)) {
+        uint64_t now = ktime_get_ns();
+        if (now < deadline) {
+            thread_block_timeout(deadline - now);
+            continue;
         }
         
-        // Discard any received data
-        if (*SPI_CS & SPI_CS_RXD) {
-            (void)*SPI_FIFO;
+        // Lost interrupt or stalled DREQ: stop both channels and flush the
+        // FIFOs, unless the completion won the race
+        flags = irq_save();
+        spin_lock(&spi_dma.lock);
+        if (!spi_dma.complete) {
+            dma_abort(SPI_DMA_TX_CHANNEL);
+            dma_abort(SPI_DMA_RX_CHANNEL);
+            *SPI_CS = spi_cs_config | SPI_CS_CLEAR_RX | SPI_CS_CLEAR_TX;
+            spi_dma.status = SPI_ERROR_TIMEOUT;
+            spi_dma.complete = true;
         }
+        spin_unlock(&spi_dma.lock);
+        irq_restore(flags);
     }
     
-    // Wait for transfer to complete
-    spi_status_t status = spi_wait_done();
+    // End transfer
+    *SPI_CS = spi_cs_config;
     
-    // Discard any remaining data from FIFO
-    while (*SPI_CS & SPI_CS_RXD) {
-        (void)*SPI_FIFO;
+    for (uint32_t i = 0; i < count; i++) {
+        if (rx_bufs[i] == NULL) {
+            continue;
+        }
+        dma_sync_for_cpu(rx_bufs[i], segs[i].len, DMA_FROM_DEVICE);
+        if (rx_bufs[i] != segs[i].rx) {
+            memcpy(segs[i].rx, rx_bufs[i], segs[i].len);
+            dma_buf_free(rx_bufs[i]);
+        }
     }
     
-    // End transfer
-    *SPI_CS = *SPI_CS & ~SPI_CS_TA;
-    
-    return status;
+    if (pooled) {
+        dma_buf_free(block);
+    } else {
+        page_free(block);
+    }
+    return spi_dma.status;
 }
 
-// Read data over SPI (send zeros)
-spi_status_t spi_read(uint8_t* rx_data, uint32_t len) {
+// Transfer a list of segments back to back under one CS assertion
+spi_status_t spi_transfer_sg(const spi_segment_t* segs, uint32_t count) {
     if (!spi_initialized) {
         return SPI_ERROR_INIT;
     }
     
-    if (rx_data == NULL || len == 0) {
+    if (segs == NULL || count == 0) {
         return SPI_ERROR_PARAM;
     }
     
-    // Wait if SPI is busy
-    if (*SPI_CS & SPI_CS_TA) {
-        return SPI_ERROR_BUSY;
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        total += segs[i].len;
+    }
+    if (total == 0) {
+        return SPI_ERROR_PARAM;
     }
     
-    // Clear FIFOs
-    *SPI_CS = *SPI_CS | SPI_CS_CLEAR_RX | SPI_CS_CLEAR_TX;
-    
-    // Set data length
-    *SPI_DLEN = len;
-    
-    // Start transfer
-    *SPI_CS = *SPI_CS | SPI_CS_TA;
+    mutex_lock(&spi_bus_lock);
     
-    // Transfer data
-    uint32_t count = 0;
-    while (count < len) {
-        // Write zeros if FIFO has space
-        if ((*SPI_CS & SPI_CS_TXD) && count < len) {
-            *SPI_FIFO = 0;
-            count++;
-        }
-        
-        // Read data if FIFO has data
-        if (*SPI_CS & SPI_CS_RXD) {
-            rx_data[count - 1] = *SPI_FIFO;
-        }
+    // Only another bus master could have left a transfer active
+    spi_status_t status;
+    if (*SPI_CS & SPI_CS_TA) {
+        status = SPI_ERROR_BUSY;
+    } else if (spi_dma_eligible(segs, count, total)) {
+        status = spi_transfer_dma(segs, count, total);
+    } else {
+        status = spi_transfer_pio(segs, total);
     }
     
-    // Wait for transfer to complete
-    spi_status_t status = spi_wait_done();
+    mutex_unlock(&spi_bus_lock);
+    return status;
+}
+
+// Transfer data over SPI (simultaneous read/write)
+spi_status_t spi_transfer(const uint8_t* tx_data, uint8_t* rx_data, uint32_t len) {
+    if (tx_data == NULL || rx_data == NULL) {
+        return SPI_ERROR_PARAM;
+    }
     
-    // Read any remaining data from FIFO
-    while (*SPI_CS & SPI_CS_RXD) {
-        rx_data[count - 1] = *SPI_FIFO;
-        count++;
+    spi_segment_t seg = { tx_data, rx_data, len };
+    return spi_transfer_sg(&seg, 1);
+}
+
+// Write data over SPI (ignore received data)
+spi_status_t spi_write(const uint8_t* tx_data, uint32_t len) {
+    if (tx_data == NULL) {
+        return SPI_ERROR_PARAM;
     }
     
-    // End transfer
-    *SPI_CS = *SPI_CS & ~SPI_CS_TA;
+    spi_segment_t seg = { tx_data, NULL, len };
+    return spi_transfer_sg(&seg, 1);
+}
+
+// Read data over SPI (send zeros)
+spi_status_t spi_read(uint8_t* rx_data, uint32_t len) {
+    if (rx_data == NULL) {
+        return SPI_ERROR_PARAM;
+    }
     
-    return status;
+    spi_segment_t seg = { NULL, rx_data, len };
+    return spi_transfer_sg(&seg, 1);
 }
 
-// Write command and then read data over SPI
+// Write command and then read data over SPI, keeping CS asserted between
 spi_status_t spi_write_read(const uint8_t* tx_data, uint32_t tx_len, uint8_t* rx_data, uint32_t rx_len) {
-    spi_status_t status;
-    
-    // Write command
-    status = spi_write(tx_data, tx_len);
-    if (status != SPI_SUCCESS) {
-        return status;
+    if (tx_data == NULL || rx_data == NULL || tx_len == 0 || rx_len == 0) {
+        return SPI_ERROR_PARAM;
     }
     
-    // Read data
-    status = spi_read(rx_data, rx_len);
-    
-    return status;
+    spi_segment_t segs[2] = {
+        { tx_data, NULL, tx_len },
+        { NULL, rx_data, rx_len },
+    };
+    return spi_transfer_sg(segs, 2);
 }
 
 // Set SPI clock speed
@@ -321,12 +709,15 @@ spi_status_t spi_set_clock_speed(uint32_t clock_speed) {
     if (divider < 2) divider = 2;
     if (divider > 65536) divider = 65536;
     
+    mutex_lock(&spi_bus_lock);
+    
     // Set clock divider
     *SPI_CLK = divider;
     
     // Update current configuration
     current_config.clock_speed = clock_speed;
     
+    mutex_unlock(&spi_bus_lock);
     return SPI_SUCCESS;
 }
 
@@ -336,8 +727,10 @@ spi_status_t spi_set_mode(spi_cpol_t cpol, spi_cpha_t cpha) {
         return SPI_ERROR_INIT;
     }
     
+    mutex_lock(&spi_bus_lock);
+    
     // Update CS register
-    uint32_t cs_reg = *SPI_CS;
+    uint32_t cs_reg = spi_cs_config;
     
     // Clear mode bits
     cs_reg &= ~(SPI_CS_CPOL | SPI_CS_CPHA);
@@ -353,10 +746,12 @@ spi_status_t spi_set_mode(spi_cpol_t cpol, spi_cpha_t cpha) {
     
     // Apply configuration
     *SPI_CS = cs_reg;
+    spi_cs_config = cs_reg;
     
     // Update current configuration
     current_config.cpol = cpol;
     current_config.cpha = cpha;
     
+    mutex_unlock(&spi_bus_lock);
     return SPI_SUCCESS;
 }
\ No newline at end of file
@@ -17,7 +17,8 @@ typedef enum {
     SPI_ERROR_INIT = -1,
     SPI_ERROR_BUSY = -2,
     SPI_ERROR_TIMEOUT = -3,
-    SPI_ERROR_PARAM = -4
+    SPI_ERROR_PARAM = -4,
+    SPI_ERROR_DMA = -5
 } spi_status_t;
 
 // SPI clock polarity
@@ -48,6 +49,14 @@ typedef struct {
     uint8_t bits_per_word; // Bits per word (8-16)
 } spi_config_t;
 
+// One piece of a scatter-gather transfer. A NULL tx sends zeros for the
+// segment and a NULL rx discards what the device sends back.
+typedef struct {
+    const uint8_t* tx;
+    uint8_t* rx;
+    uint32_t len;
+} spi_segment_t;
+
 // Initialize SPI controller
 spi_status_t spi_init(const spi_config_t* config);
 
@@ -60,7 +69,14 @@ spi_status_t spi_write(const uint8_t* tx_data, uint32_t len);
 // Read data over SPI (send zeros)
 spi_status_t spi_read(uint8_t* rx_data, uint32_t len);
 
-// Write command and then read data over SPI
+// Transfer a list of segments under a single CS assertion. Large
+// transfers of word-aligned buffers run by DMA while the caller sleeps;
+// buffers received into must not share cache lines with other data.
+// Concurrent callers queue for the bus. Returns SPI_ERROR_TIMEOUT if the
+// transfer does not finish in time.
+spi_status_t spi_transfer_sg(const spi_segment_t* segs, uint32_t count);
+
+// Write command and then read data over SPI, keeping CS asserted between
 spi_status_t spi_write_read(const uint8_t* tx_data, uint32_t tx_len, uint8_t* rx_data, uint32_t rx_len);
 
 // Set SPI clock speed
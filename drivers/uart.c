@@ -69,7 +69,14 @@
 //
 
 #include "uart.h"
+#include "intc.h"
+#include "../kernel/irq.h"
+#include "../kernel/sched.h"
+#include "../kernel/spinlock.h"
+#include "../kernel/console.h"
+#include "../kernel/stdio.h"
 #include <stdarg.h>
+#include <stdbool.h>
 
 // Memory-Mapped I/O addresses for Raspberry Pi
 #define MMIO_BASE       0x3F000000  // For Raspberry Pi 3/4
@@ -82,14 +89,79 @@
 #define UART0_FBRD      ((volatile unsigned int*)(MMIO_BASE + 0x00201028))
 #define UART0_LCRH      ((volatile unsigned int*)(MMIO_BASE + 0x0020102C))
 #define UART0_CR        ((volatile unsigned int*)(MMIO_BASE + 0x00201030))
+#define UART0_IFLS      ((volatile unsigned int*)(MMIO_BASE + 0x00201034))
 #define UART0_IMSC      ((volatile unsigned int*)(MMIO_BASE + 0x00201038))
+#define UART0_MIS       ((volatile unsigned int*)(MMIO_BASE + 0x00201040))
 #define UART0_ICR       ((volatile unsigned int*)(MMIO_BASE + 0x00201044))
 
+// Flag and interrupt bits
+#define UART_FR_RXFE    (1 << 4)
+#define UART_FR_TXFF    (1 << 5)
+#define UART_INT_RX     (1 << 4)
+#define UART_INT_TX     (1 << 5)
+#define UART_INT_RT     (1 << 6)
+
+// Receive ring buffer behind the hardware FIFO; size is a power of two
+#define UART_RX_BUFFER_SIZE 256
+
 // GPIO registers
 #define GPFSEL1         ((volatile unsigned int*)(MMIO_BASE + 0x00200004))
 #define GPPUD           ((volatile unsigned int*)(MMIO_BASE + 0x00200094))
 #define GPPUDCLK0       ((volatile unsigned int*)(MMIO_BASE + 0x00200098))
 
+// Interrupt-driven state, used once uart_irq_init() succeeds
+static volatile bool uart_irq_mode = false;
+static spinlock_t uart_lock = SPINLOCK_INIT;
+
+static char rx_buffer[UART_RX_BUFFER_SIZE];
+static uint32_t rx_head, rx_tail;
+static thread_t* rx_waiter = NULL;
+static uint32_t rx_overruns = 0;
+
+// Write one byte to the hardware, waiting for FIFO space
+static void uart_hw_putc(unsigned char c) {
+    while (*UART0_FR & UART_FR_TXFF) { }
+    *UART0_DR = c;
+}
+
+// PL011 interrupt: fill the RX ring and let the console refill the TX FIFO
+static void uart_irq(uint32_t irq, void* arg) {
+    (void)irq;
+    (void)arg;
+
+    uint32_t status = *UART0_MIS;
+    *UART0_ICR = status & (UART_INT_RX | UART_INT_RT | UART_INT_TX);
+
+    if (status & (UART_INT_RX | UART_INT_RT)) {
+        spin_lock(&uart_lock);
+
+        while (!(*UART0_FR & UART_FR_RXFE)) {
+            char c = (char)*UART0_DR;
+            if (rx_head - rx_tail < UART_RX_BUFFER_SIZE) {
+                rx_buffer[rx_head++ & (UART_RX_BUFFER_SIZE - 1)] = c;
+            } else {
+                rx_overruns++;
+            }
+        }
+
+        thread_t* waiter = NULL;
+        if (rx_head != rx_tail) {
+            waiter = rx_waiter;
+            rx_waiter = NULL;
+        }
+
+        spin_unlock(&uart_lock);
+
+        if (waiter) {
+            thread_wake(waiter);
+        }
+    }
+
+    if (status & UART_INT_TX) {
+        console_drain();
+    }
+}
+
 // Initialize UART
 void uart_init() {
     // Disable UART0
@@ -135,89 +207,155 @@ void uart_init() {
     *UART0_CR = (1 << 0) | (1 << 8) | (1 << 9);
 }
 
+// Switch RX and TX over to interrupts
+bool uart_irq_init() {
+    // Interrupt when the RX FIFO is 1/8 full or on receive timeout, and
+    // when the TX FIFO drains to 1/8
+    *UART0_IFLS = 0;
+    *UART0_ICR = 0x7FF;
+
+    if (!irq_register(IRQ_UART0, uart_irq, NULL)) {
+        return false;
+    }
+
+    *UART0_IMSC = UART_INT_RX | UART_INT_RT;
+    uart_irq_mode = true;
+
+    // Output can now be buffered and drained by the TX interrupt
+    console_set_buffered(true);
+    return true;
+}
+
+// Flush buffered console output and fall back to polled I/O
+void uart_set_polled() {
+    console_flush();
+    console_set_buffered(false);
+
+    uart_irq_mode = false;
+    *UART0_IMSC = 0;
+}
+
+// Copy as much as fits into the TX FIFO without waiting
+uint32_t uart_tx_write(const char* data, uint32_t len) {
+    uint32_t written = 0;
+    while (written < len && !(*UART0_FR & UART_FR_TXFF)) {
+        *UART0_DR = data[written++];
+    }
+    return written;
+}
+
+// Unmask or mask the TX FIFO interrupt. It fires when the FIFO drains
+// below its trigger level, so it only needs to be on while output waits.
+void uart_tx_irq_enable(bool enable) {
+    if (enable) {
+        *UART0_IMSC |= UART_INT_TX;
+    } else {
+        *UART0_IMSC &= ~UART_INT_TX;
+    }
+}
+
 // Send a character
 void uart_putc(unsigned char c) {
-    // Wait until transmit FIFO is not full
-    while (*UART0_FR & (1 << 5)) { }
-    
-    // Write the character to the data register
-    *UART0_DR = c;
-    
-    // If it's a newline, also send a carriage return
+    if (console_buffered()) {
+        char ch = (char)c;
+        console_write(&ch, 1);
+        return;
+    }
+
+    uart_hw_putc(c);
     if (c == '\n') {
-        uart_putc('\r');
+        uart_hw_putc('\r');
     }
 }
 
 // Receive a character
 unsigned char uart_getc() {
-    // Wait until receive FIFO is not empty
-    while (*UART0_FR & (1 << 4)) { }
-    
-    // Read the character from the data register
-    return *UART0_DR;
+    if (!uart_irq_mode) {
+        // Wait until receive FIFO is not empty
+        while (*UART0_FR & UART_FR_RXFE) { }
+        
+        // Read the character from the data register
+        return *UART0_DR;
+    }
+
+    // Sleep until the RX interrupt has queued a character
+    while (1) {
+        unsigned long flags = irq_save();
+        spin_lock(&uart_lock);
+        if (rx_head != rx_tail) {
+            char c = rx_buffer[rx_tail++ & (UART_RX_BUFFER_SIZE - 1)];
+            spin_unlock(&uart_lock);
+            irq_restore(flags);
+            return c;
+        }
+        rx_waiter = thread_current();
+        spin_unlock(&uart_lock);
+        irq_restore(flags);
+
+        thread_block();
+    }
+}
+
+// Bytes dropped because the RX ring was full
+uint32_t uart_rx_overruns() {
+    return rx_overruns;
+}
+
+// Send len bytes
+void uart_write(const char* data, uint32_t len) {
+    if (console_buffered()) {
+        console_write(data, len);
+        return;
+    }
+
+    for (uint32_t i = 0; i < len; i++) {
+        uart_putc(data[i]);
+    }
 }
 
 // Send a string
 void uart_puts(const char* str) {
-    while (*str) {
-        uart_putc(*str++);
+    uint32_t len = 0;
+    while (str[len]) {
+        len++;
     }
+    uart_write(str, len);
 }
 
-// Simple printf implementation
+// Collects formatted output so that most messages reach the console in one
+// write; longer output is passed on in chunks rather than truncated
+#define UART_PRINTF_CHUNK 128
+
+typedef struct {
+    char buffer[UART_PRINTF_CHUNK];
+    uint32_t len;
+} uart_printf_ctx_t;
+
+static void uart_printf_sink(void* ctx, const char* data, size_t len) {
+    uart_printf_ctx_t* state = (uart_printf_ctx_t*)ctx;
+
+    if (state->len + len > UART_PRINTF_CHUNK) {
+        uart_write(state->buffer, state->len);
+        state->len = 0;
+        if (len > UART_PRINTF_CHUNK) {
+            uart_write(data, len);
+            return;
+        }
+    }
+
+    memcpy(state->buffer + state->len, data, len);
+    state->len += len;
+}
+
+// Formatted output, see vsinkprintf() for the supported conversions
 void uart_printf(const char* format, ...) {
+    uart_printf_ctx_t state;
+    state.len = 0;
+
     va_list args;
     va_start(args, format);
-    
-    char buffer[256];
-    int len = 0;
-    
-    while (*format && len < 255) {
-        if (*format == '%') {
-            format++;
-            switch (*format) {
-                case 's': {
-                    const char* str = va_arg(args, const char*);
-                    while (*str && len < 255) {
-                        buffer[len++] = *str++;
-                    }
-                    break;
-                }
-                case 'd': {
-                    int num = va_arg(args, int);
-                    if (num < 0) {
-                        buffer[len++] = '-';
-                        num = -num;
-                    }
-                    char temp[16];
-                    int i = 0;
-                    do {
-                        temp[i++] = '0' + (num % 10);
-                        num /= 10;
-                    } while (num > 0);
-                    while (i > 0 && len < 255) {
-                        buffer[len++] = temp[--i];
-                    }
-                    break;
-                }
-                case 'c': {
-                    char c = (char)va_arg(args, int);
-                    buffer[len++] = c;
-                    break;
-                }
-                default:
-                    buffer[len++] = *format;
-                    break;
-            }
-        } else {
-            buffer[len++] = *format;
-        }
-        format++;
-    }
-    
-    buffer[len] = '\0';
-    uart_puts(buffer);
-    
+    vsinkprintf(uart_printf_sink, &state, format, args);
     va_end(args);
-}
\ No newline at end of file
+
+    uart_write(state.buffer, state.len);
+}
@@ -71,9 +71,30 @@
 #ifndef UART_H
 #define UART_H
 
+#include "types.h"
+#include <stdbool.h>
+
 // Initialize UART
 void uart_init();
 
+// Switch RX and TX over to interrupts; needs irq_init() and the scheduler.
+// Until then, and if this fails, the UART is polled.
+bool uart_irq_init();
+
+// Flush buffered console output and fall back to polled I/O, e.g. before
+// a panic
+void uart_set_polled();
+
+// Copy as much as fits into the TX FIFO without waiting; returns the
+// number of bytes taken. Used by the console drain.
+uint32_t uart_tx_write(const char* data, uint32_t len);
+
+// Unmask or mask the TX FIFO interrupt
+void uart_tx_irq_enable(bool enable);
+
+// Bytes dropped because the RX ring was full
+uint32_t uart_rx_overruns();
+
 // Send a character
 void uart_putc(unsigned char c);
 
@@ -83,7 +104,10 @@ unsigned char uart_getc();
 // Send a string
 void uart_puts(const char* str);
 
-// Printf-like function
-void uart_printf(const char* format, ...);
+// Send len bytes
+void uart_write(const char* data, uint32_t len);
+
+// Printf-like function, see vsinkprintf() in kernel/stdio.h
+void uart_printf(const char* format, ...) __attribute__((format(printf, 1, 2)));
 
 #endif // UART_H
\ No newline at end of file
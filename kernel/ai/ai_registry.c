@@ -0,0 +1,157 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ *
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "ai_registry.h"
+#include "../spinlock.h"
+#include "../irq.h"
+#include "../sched.h"
+
+#define AI_REGISTRY_MASK (AI_REGISTRY_SLOTS - 1)
+#define AI_REGISTRY_GEN_MASK (0xFFFFFFFFu >> AI_REGISTRY_BITS)
+
+// A slot is live while its generation is odd, so slot 0 never forms handle
+// 0. Readers count themselves in refs before checking the generation, and
+// removal retires the generation before waiting for refs to drain, so
+// either the reader misses or the remover waits for it.
+typedef struct {
+    volatile uint32_t generation;
+    volatile uint32_t refs;
+    void* volatile obj;
+    ai_registry_kind_t kind;
+} ai_registry_slot_t;
+
+static ai_registry_slot_t slots[AI_REGISTRY_SLOTS];
+
+// Free slot stack; writers serialize on registry_lock
+static spinlock_t registry_lock = SPINLOCK_INIT;
+static uint16_t free_slots[AI_REGISTRY_SLOTS];
+static uint32_t num_free = 0;
+static bool registry_ready = false;
+
+static inline uint32_t make_handle(uint32_t index, uint32_t generation) {
+    return (generation << AI_REGISTRY_BITS) | index;
+}
+
+// Claim a slot
+uint32_t ai_registry_add(ai_registry_kind_t kind, void* obj) {
+    unsigned long flags = irq_save();
+    spin_lock(&registry_lock);
+
+    if (!registry_ready) {
+        // Hand out low slots first
+        for (uint32_t i = 0; i < AI_REGISTRY_SLOTS; i++) {
+            free_slots[i] = (uint16_t)(AI_REGISTRY_SLOTS - 1 - i);
+        }
+        num_free = AI_REGISTRY_SLOTS;
+        registry_ready = true;
+    }
+
+    uint32_t handle = 0;
+    if (num_free > 0) {
+        uint32_t index = free_slots[--num_free];
+        ai_registry_slot_t* slot = &slots[index];
+        slot->kind = kind;
+        __atomic_store_n(&slot->obj, obj, __ATOMIC_RELAXED);
+        uint32_t generation = (slot->generation + 1) & AI_REGISTRY_GEN_MASK;
+        __atomic_store_n(&slot->generation, generation, __ATOMIC_RELEASE);
+        handle = make_handle(index, generation);
+    }
+
+    spin_unlock(&registry_lock);
+    irq_restore(flags);
+    return handle;
+}
+
+// Publish a reserved handle's object
+void ai_registry_set(uint32_t handle, void* obj) {
+    ai_registry_slot_t* slot = &slots[handle & AI_REGISTRY_MASK];
+    __atomic_store_n(&slot->obj, obj, __ATOMIC_RELEASE);
+}
+
+// Retire a handle, wait out its references, then free the slot
+bool ai_registry_remove(uint32_t handle) {
+    uint32_t index = handle & AI_REGISTRY_MASK;
+    ai_registry_slot_t* slot = &slots[index];
+    bool removed = false;
+
+    unsigned long flags = irq_save();
+    spin_lock(&registry_lock);
+
+    if ((slot->generation & 1) != 0 && make_handle(index, slot->generation) == handle) {
+        // New lookups miss from here on
+        __atomic_store_n(&slot->generation, (slot->generation + 1) & AI_REGISTRY_GEN_MASK, __ATOMIC_SEQ_CST);
+        removed = true;
+    }
+
+    spin_unlock(&registry_lock);
+    irq_restore(flags);
+    if (!removed) {
+        return false;
+    }
+
+    // Holders may sleep on the bus, so give them the CPU when we can
+    bool can_yield = thread_current() != NULL && !irq_disabled();
+    while (__atomic_load_n(&slot->refs, __ATOMIC_SEQ_CST) != 0) {
+        if (can_yield) {
+            sched_yield();
+        } else {
+            cpu_relax();
+        }
+    }
+
+    // Only now may the slot be handed out again
+    flags = irq_save();
+    spin_lock(&registry_lock);
+    __atomic_store_n(&slot->obj, NULL, __ATOMIC_RELAXED);
+    free_slots[num_free++] = (uint16_t)index;
+    spin_unlock(&registry_lock);
+    irq_restore(flags);
+    return true;
+}
+
+// Look up a handle and take a reference, without locking
+void* ai_registry_get(uint32_t handle, ai_registry_kind_t kind) {
+    ai_registry_slot_t* slot = &slots[handle & AI_REGISTRY_MASK];
+    uint32_t generation = handle >> AI_REGISTRY_BITS;
+
+    if (__atomic_load_n(&slot->generation, __ATOMIC_ACQUIRE) != generation) {
+        return NULL;
+    }
+    __atomic_add_fetch(&slot->refs, 1, __ATOMIC_SEQ_CST);
+    void* obj = NULL;
+    if (__atomic_load_n(&slot->generation, __ATOMIC_SEQ_CST) == generation && slot->kind == kind) {
+        obj = __atomic_load_n(&slot->obj, __ATOMIC_ACQUIRE);
+    }
+    if (obj == NULL) {
+        // Gone, reused, another kind or not published yet
+        __atomic_sub_fetch(&slot->refs, 1, __ATOMIC_RELEASE);
+    }
+    return obj;
+}
+
+// Drop a reference
+void ai_registry_put(uint32_t handle) {
+    __atomic_sub_fetch(&slots[handle & AI_REGISTRY_MASK].refs, 1, __ATOMIC_RELEASE);
+}
+
+// Walk the published entries of a kind
+void* ai_registry_next(ai_registry_kind_t kind, uint32_t* cursor, uint32_t* handle) {
+    while (*cursor < AI_REGISTRY_SLOTS) {
+        uint32_t index = (*cursor)++;
+        uint32_t generation = __atomic_load_n(&slots[index].generation, __ATOMIC_ACQUIRE);
+        if ((generation & 1) == 0) {
+            continue;
+        }
+        void* obj = ai_registry_get(make_handle(index, generation), kind);
+        if (obj != NULL) {
+            *handle = make_handle(index, generation);
+            return obj;
+        }
+    }
+    return NULL;
+}
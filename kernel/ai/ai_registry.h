@@ -0,0 +1,55 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ *
+ * ───────────────────────────────────────────────────────────────────────────── */
+#ifndef AI_REGISTRY_H
+#define AI_REGISTRY_H
+
+#include "../types.h"
+#include <stdbool.h>
+
+// Slots in the model registry, shared by every kind of entry
+#define AI_REGISTRY_BITS    8
+#define AI_REGISTRY_SLOTS   (1u << AI_REGISTRY_BITS)
+
+// Handles are a slot index in the low AI_REGISTRY_BITS and the slot's
+// generation above it. Freeing a slot bumps its generation, so stale
+// handles miss instead of finding whatever reused the slot. 0 is never a
+// valid handle.
+
+// What a registry entry describes
+typedef enum {
+    AI_REGISTRY_HAT_MODEL = 1,  // Model on the AI HAT+ (ai_hat)
+    AI_REGISTRY_MODEL = 2       // Model known to the AI subsystem
+} ai_registry_kind_t;
+
+// Claim a slot for obj and return its handle, or 0 if the registry is
+// full. obj may be NULL to reserve a handle and publish later.
+uint32_t ai_registry_add(ai_registry_kind_t kind, void* obj);
+
+// Publish the object behind a reserved handle
+void ai_registry_set(uint32_t handle, void* obj);
+
+// Retire a handle and wait until nobody holds a reference to it, so the
+// caller may free the object once this returns true. Must not be called
+// while holding a reference to the handle, or from interrupt context.
+bool ai_registry_remove(uint32_t handle);
+
+// Object behind a handle of the given kind, or NULL. Takes no lock and is
+// safe on any core, IRQ handlers included. A non-NULL result holds a
+// reference that keeps the object alive until ai_registry_put().
+void* ai_registry_get(uint32_t handle, ai_registry_kind_t kind);
+
+// Drop a reference taken by ai_registry_get() or ai_registry_next()
+void ai_registry_put(uint32_t handle);
+
+// Walk the published entries of a kind in slot order. Start with
+// *cursor = 0; returns NULL at the end. *handle gets each entry's handle,
+// which the caller passes to ai_registry_put() when done with the entry.
+void* ai_registry_next(ai_registry_kind_t kind, uint32_t* cursor, uint32_t* handle);
+
+#endif // AI_REGISTRY_H
@@ -9,17 +9,201 @@
 #include "ai_subsystem.h"
 #include "../../drivers/ai_hat/ai_hat.h"
 #include "../memory.h"
+#include "../slab.h"
+#include "../arena.h"
+#include "ai_registry.h"
+#include "../irq.h"
+#include "../mutex.h"
+#include "../sched.h"
+#include "../spinlock.h"
+#include "../timer.h"
 #include "../../drivers/uart.h"
+#include "../../drivers/dma.h"
 #include <stdbool.h>
 #include "../stdio.h"
 
-// Maximum number of models that can be loaded
-#define MAX_MODELS 8
+#define AI_RING_MASK (AI_RING_ENTRIES - 1)
+_Static_assert((AI_RING_ENTRIES & AI_RING_MASK) == 0, "AI_RING_ENTRIES must be a power of two");
+
+// Loaded model, allocated from the model cache on demand. desc.id is its
+// handle in the AI registry and stays fixed while the model moves on and
+// off the AI HAT+; hat_id is its ID on the HAT while resident.
+typedef struct ai_model_entry {
+    ai_model_descriptor_t desc;
+    uint32_t hat_id;
+    bool resident;
+    uint32_t size;
+    ai_hat_model_reader_t reader;       // Source to reload the model from
+    void* ctx;
+    struct ai_model_entry* lru_prev;    // Resident models, most recent first
+    struct ai_model_entry* lru_next;
+} ai_model_entry_t;
+
+// Serializes everything that runs on the AI HAT+ or changes what is on
+// it: inference on every path (synchronous, batched, pipelined and the
+// AI worker), loads, unloads and evictions, and with them the LRU list,
+// the residency counters and the model table. Held across SPI transfers.
+static mutex_t hat_lock = MUTEX_INIT;
 
 // Static variables
 static bool ai_subsystem_initialized = false;
-static ai_model_descriptor_t loaded_models[MAX_MODELS];
+static kmem_cache_t* model_cache = NULL;
 static uint32_t num_loaded_models = 0;
+static ai_model_entry_t* lru_head = NULL;
+static ai_model_entry_t* lru_tail = NULL;
+static ai_residency_stats_t residency;
+
+// Staging scratch for inference run on callers' threads. hat_lock
+// serializes those requests, and each resets it before dropping the lock.
+static arena_t caller_arena;
+
+// Submission and completion rings. Head and tail run freely and are masked
+// on access. outstanding counts requests submitted but not yet reaped (or
+// called back), so neither ring can overflow; polled counts the subset that
+// will post to the completion ring.
+static spinlock_t ring_lock = SPINLOCK_INIT;
+static ai_request_t sq[AI_RING_ENTRIES];
+static ai_completion_t cq[AI_RING_ENTRIES];
+static uint32_t sq_head, sq_tail;
+static uint32_t cq_head, cq_tail;
+static uint32_t outstanding;
+static uint32_t polled;
+static uint32_t pending;        // Submitted, not yet completed
+static thread_t* ai_worker = NULL;
+static thread_t* reap_waiter = NULL;
+
+static void ai_worker_main(void* arg);
+static ai_subsystem_status_t register_model(ai_model_entry_t* entry, uint32_t hat_id, ai_model_type_t type,
+                                            ai_model_descriptor_t* descriptor);
+
+// Bytes in one frame of a tensor; dims[0] is the batch dimension
+static uint32_t frame_size(const uint32_t dims[4]) {
+    return dims[1] * dims[2] * dims[3];
+}
+
+// Find a loaded model by ID and take a reference, dropped with
+// ai_registry_put(model_id). Unloading waits for references, so callers
+// outside hat_lock must not block on it while holding one.
+static ai_model_entry_t* get_model(uint32_t model_id) {
+    return (ai_model_entry_t*)ai_registry_get(model_id, AI_REGISTRY_MODEL);
+}
+
+// Whether a model is loaded right now
+static bool model_exists(uint32_t model_id) {
+    if (get_model(model_id) == NULL) {
+        return false;
+    }
+    ai_registry_put(model_id);
+    return true;
+}
+
+// Take a model off the LRU list
+static void lru_unlink(ai_model_entry_t* entry) {
+    if (entry->lru_prev != NULL) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        lru_head = entry->lru_next;
+    }
+    if (entry->lru_next != NULL) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        lru_tail = entry->lru_prev;
+    }
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+// Put a model at the most recently used end of the LRU list
+static void lru_push(ai_model_entry_t* entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = lru_head;
+    if (lru_head != NULL) {
+        lru_head->lru_prev = entry;
+    } else {
+        lru_tail = entry;
+    }
+    lru_head = entry;
+}
+
+// Mark a resident model as just used
+static void lru_touch(ai_model_entry_t* entry) {
+    if (lru_head != entry) {
+        lru_unlink(entry);
+        lru_push(entry);
+    }
+}
+
+// Unload the least recently used resident model other than keep
+static bool evict_lru(ai_model_entry_t* keep) {
+    ai_model_entry_t* victim = lru_tail;
+    if (victim == keep) {
+        victim = victim->lru_prev;
+    }
+    if (victim == NULL) {
+        return false;
+    }
+    
+    // The HAT handle is gone even if the HAT failed to drop the model
+    bool unloaded = ai_hat_unload_model(victim->hat_id) == AI_HAT_SUCCESS;
+    
+    lru_unlink(victim);
+    victim->resident = false;
+    residency.evictions++;
+    residency.resident_models--;
+    residency.resident_bytes -= victim->size;
+    return unloaded;
+}
+
+// Start an upload, evicting models until it fits in accelerator memory
+static ai_hat_status_t upload_init(ai_hat_upload_t* upload, uint32_t size, ai_model_entry_t* keep) {
+    ai_hat_info_t info;
+    if (ai_hat_get_info(&info) == AI_HAT_SUCCESS && size > info.memory_size) {
+        // Would not fit on an empty HAT; evicting is pointless
+        return AI_HAT_ERROR_MEMORY;
+    }
+    
+    while (size > ai_hat_memory_free() && evict_lru(keep)) {
+    }
+    
+    return ai_hat_upload_init(upload, size);
+}
+
+// Make sure a model is on the AI HAT+, reloading it from its source if it
+// was evicted. Called with hat_lock held, like everything that touches the
+// LRU list.
+static ai_subsystem_status_t make_resident(ai_model_entry_t* entry) {
+    if (entry->resident) {
+        residency.hits++;
+        lru_touch(entry);
+        return AI_SUBSYSTEM_SUCCESS;
+    }
+    
+    residency.misses++;
+    
+    ai_hat_upload_t upload;
+    uint32_t hat_id;
+    ai_hat_status_t status = upload_init(&upload, entry->size, entry);
+    if (status == AI_HAT_SUCCESS) {
+        status = ai_hat_upload_model(&upload, entry->reader, entry->ctx, &hat_id);
+        ai_hat_upload_abort(&upload);
+    }
+    if (status == AI_HAT_SUCCESS &&
+        ai_hat_set_model_io(hat_id, frame_size(entry->desc.input_dims),
+                            frame_size(entry->desc.output_dims)) != AI_HAT_SUCCESS) {
+        ai_hat_unload_model(hat_id);
+        status = AI_HAT_ERROR_MODEL;
+    }
+    if (status != AI_HAT_SUCCESS) {
+        return status == AI_HAT_ERROR_MEMORY ? AI_SUBSYSTEM_ERROR_MEMORY : AI_SUBSYSTEM_ERROR_MODEL;
+    }
+    
+    entry->hat_id = hat_id;
+    entry->resident = true;
+    lru_push(entry);
+    residency.resident_models++;
+    residency.resident_bytes += entry->size;
+    return AI_SUBSYSTEM_SUCCESS;
+}
 
 // Initialize the AI subsystem
 ai_subsystem_status_t ai_subsystem_init(void) {
@@ -30,6 +214,15 @@ ai_subsystem_status_t ai_subsystem_init(void) {
     
     uart_puts("Initializing AI subsystem...\n");
     
+    // Model descriptors are allocated on demand
+    if (model_cache == NULL) {
+        model_cache = kmem_cache_create("ai_model", sizeof(ai_model_entry_t), 0, NULL);
+        if (model_cache == NULL) {
+            uart_puts("Failed to create AI model cache\n");
+            return AI_SUBSYSTEM_ERROR_MEMORY;
+        }
+    }
+    
     // Initialize AI HAT+
     ai_hat_status_t status = ai_hat_init();
     if (status != AI_HAT_SUCCESS) {
@@ -39,6 +232,17 @@ ai_subsystem_status_t ai_subsystem_init(void) {
     
     // Initialize model list
     num_loaded_models = 0;
+    lru_head = NULL;
+    lru_tail = NULL;
+    memset(&residency, 0, sizeof(residency));
+    
+    // Worker for ai_submit(); requests run inline if it cannot be started
+    if (ai_worker == NULL) {
+        ai_worker = thread_create("ai_worker", ai_worker_main, NULL);
+        if (ai_worker == NULL) {
+            uart_puts("AI worker not started, async requests run inline\n");
+        }
+    }
     
     ai_subsystem_initialized = true;
     uart_puts("AI subsystem initialized successfully\n");
@@ -76,21 +280,103 @@ ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t m
         return AI_SUBSYSTEM_ERROR_PARAM;
     }
     
-    if (num_loaded_models >= MAX_MODELS) {
+    ai_model_entry_t* entry = (ai_model_entry_t*)kmem_cache_alloc(model_cache);
+    if (entry == NULL) {
         return AI_SUBSYSTEM_ERROR_MEMORY;
     }
     
-    // Load model to AI HAT+
-    uint32_t model_id;
-    ai_hat_status_t status = ai_hat_load_model(model_data, model_size, &model_id);
+    mutex_lock(&hat_lock);
+    
+    // Load model to AI HAT+, making room if needed
+    ai_hat_upload_t upload;
+    uint32_t hat_id;
+    ai_hat_status_t status = upload_init(&upload, model_size, NULL);
+    if (status == AI_HAT_SUCCESS) {
+        status = ai_hat_upload_model(&upload, ai_hat_memory_reader, (void*)model_data, &hat_id);
+        ai_hat_upload_abort(&upload);
+    }
     if (status != AI_HAT_SUCCESS) {
-        return AI_SUBSYSTEM_ERROR_MODEL;
+        mutex_unlock(&hat_lock);
+        kmem_cache_free(model_cache, entry);
+        return status == AI_HAT_ERROR_MEMORY ? AI_SUBSYSTEM_ERROR_MEMORY : AI_SUBSYSTEM_ERROR_MODEL;
     }
     
+    // The data is read again if the model is evicted and reloaded
+    entry->reader = ai_hat_memory_reader;
+    entry->ctx = (void*)model_data;
+    entry->size = model_size;
+    ai_subsystem_status_t result = register_model(entry, hat_id, type, descriptor);
+    
+    mutex_unlock(&hat_lock);
+    return result;
+}
+
+// Start a streamed model upload, evicting resident models to make room
+ai_subsystem_status_t ai_subsystem_upload_init(ai_hat_upload_t* upload, uint32_t model_size) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    mutex_lock(&hat_lock);
+    ai_hat_status_t status = upload_init(upload, model_size, NULL);
+    mutex_unlock(&hat_lock);
+    if (status != AI_HAT_SUCCESS) {
+        return status == AI_HAT_ERROR_MEMORY ? AI_SUBSYSTEM_ERROR_MEMORY : AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Stream a model to the AI HAT+ from a reader
+ai_subsystem_status_t ai_subsystem_load_model_stream(ai_hat_upload_t* upload, ai_hat_model_reader_t reader, void* ctx,
+                                                    ai_model_type_t type, ai_model_descriptor_t* descriptor) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (upload == NULL || reader == NULL || descriptor == NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    ai_model_entry_t* entry = (ai_model_entry_t*)kmem_cache_alloc(model_cache);
+    if (entry == NULL) {
+        return AI_SUBSYSTEM_ERROR_MEMORY;
+    }
+    
+    mutex_lock(&hat_lock);
+    
+    // On failure the upload keeps its progress for the caller to resume
+    uint32_t hat_id;
+    ai_hat_status_t status = ai_hat_upload_model(upload, reader, ctx, &hat_id);
+    if (status != AI_HAT_SUCCESS) {
+        mutex_unlock(&hat_lock);
+        kmem_cache_free(model_cache, entry);
+        switch (status) {
+            case AI_HAT_ERROR_MEMORY:
+                return AI_SUBSYSTEM_ERROR_MEMORY;
+            case AI_HAT_ERROR_CHECKSUM:
+                return AI_SUBSYSTEM_ERROR_CHECKSUM;
+            default:
+                return AI_SUBSYSTEM_ERROR_MODEL;
+        }
+    }
+    
+    entry->reader = reader;
+    entry->ctx = ctx;
+    entry->size = upload->size;
+    ai_subsystem_status_t result = register_model(entry, hat_id, type, descriptor);
+    
+    mutex_unlock(&hat_lock);
+    return result;
+}
+
+// Describe a model just loaded on the AI HAT+ and add it to the list.
+// Called with hat_lock held.
+static ai_subsystem_status_t register_model(ai_model_entry_t* entry, uint32_t hat_id, ai_model_type_t type,
+                                            ai_model_descriptor_t* descriptor) {
     // Create model descriptor
     ai_model_descriptor_t model;
     memset(&model, 0, sizeof(ai_model_descriptor_t));
-    model.id = model_id;
     model.type = type;
     
     // Set default input/output dimensions based on model type
@@ -162,14 +448,35 @@ ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t m
             break;
     }
     
+    // Tell the HAT what one frame of this model looks like
+    if (ai_hat_set_model_io(hat_id, frame_size(model.input_dims), frame_size(model.output_dims)) != AI_HAT_SUCCESS) {
+        ai_hat_unload_model(hat_id);
+        kmem_cache_free(model_cache, entry);
+        return AI_SUBSYSTEM_ERROR_MODEL;
+    }
+    
+    // Reserve the model's handle; it resolves once the entry is complete
+    model.id = ai_registry_add(AI_REGISTRY_MODEL, NULL);
+    if (model.id == 0) {
+        ai_hat_unload_model(hat_id);
+        kmem_cache_free(model_cache, entry);
+        return AI_SUBSYSTEM_ERROR_MEMORY;
+    }
+    
     // Set model name
-    sprintf(model.name, "Model_%u", model_id);
+    snprintf(model.name, sizeof(model.name), "Model_%u", (unsigned int)model.id);
     
     // Set precision (default to FP16)
     model.precision = AI_HAT_PRECISION_FP16;
     
-    // Add model to list
-    loaded_models[num_loaded_models] = model;
+    // Publish the model
+    entry->desc = model;
+    entry->hat_id = hat_id;
+    entry->resident = true;
+    lru_push(entry);
+    residency.resident_models++;
+    residency.resident_bytes += entry->size;
+    ai_registry_set(model.id, entry);
     num_loaded_models++;
     
     // Copy descriptor to output
@@ -184,31 +491,125 @@ ai_subsystem_status_t ai_subsystem_unload_model(uint32_t model_id) {
         return AI_SUBSYSTEM_ERROR_INIT;
     }
     
-    // Find model in list
-    int model_index = -1;
-    for (uint32_t i = 0; i < num_loaded_models; i++) {
-        if (loaded_models[i].id == model_id) {
-            model_index = i;
-            break;
+    mutex_lock(&hat_lock);
+    
+    ai_model_entry_t* entry = get_model(model_id);
+    if (entry == NULL) {
+        mutex_unlock(&hat_lock);
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    // hat_lock keeps the entry from going away; removal below waits for
+    // any other reference
+    ai_registry_put(model_id);
+    
+    // Unload model from AI HAT+ unless already evicted
+    if (entry->resident) {
+        ai_hat_status_t status = ai_hat_unload_model(entry->hat_id);
+        lru_unlink(entry);
+        entry->resident = false;
+        residency.resident_models--;
+        residency.resident_bytes -= entry->size;
+        
+        // The HAT handle is gone either way; the model stays loaded here
+        // and is reloaded on next use
+        if (status != AI_HAT_SUCCESS) {
+            mutex_unlock(&hat_lock);
+            return AI_SUBSYSTEM_ERROR_MODEL;
         }
     }
     
-    if (model_index == -1) {
+    // Retire the handle and wait out its users, then release the descriptor
+    ai_registry_remove(model_id);
+    kmem_cache_free(model_cache, entry);
+    
+    num_loaded_models--;
+    
+    mutex_unlock(&hat_lock);
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Whether the SPI DMA engine can send an input tensor in place
+static bool input_dma_ready(const void* tensor, uint32_t size) {
+    return ((uintptr_t)tensor & 3) == 0 && dma_addressable(tensor, size);
+}
+
+// Round a size up to whole cache lines
+static size_t line_align(size_t size) {
+    return (size + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+}
+
+// Run one inference request; shared by the synchronous and ring paths.
+//
+// Tensors the SPI DMA engine cannot reach in place are staged in scratch,
+// which belongs to the calling context and is reset before returning. An
+// output must own whole cache lines (dma_rx_safe()), the same rule the SPI
+// driver applies. Scratch persists and grows to the largest request it has
+// staged, so pages are only allocated the first time a model that large
+// comes through. Without room to stage, tensors go out as they are and the
+// SPI driver bounces or falls back to PIO.
+static ai_subsystem_status_t execute_inference(uint32_t model_id, const void* input, void* output,
+                                               arena_t* scratch) {
+    mutex_lock(&hat_lock);
+    
+    // Find model by handle
+    ai_model_entry_t* entry = get_model(model_id);
+    if (entry == NULL) {
+        mutex_unlock(&hat_lock);
         return AI_SUBSYSTEM_ERROR_PARAM;
     }
     
-    // Unload model from AI HAT+
-    ai_hat_status_t status = ai_hat_unload_model(model_id);
-    if (status != AI_HAT_SUCCESS) {
-        return AI_SUBSYSTEM_ERROR_MODEL;
+    ai_subsystem_status_t resident = make_resident(entry);
+    if (resident != AI_SUBSYSTEM_SUCCESS) {
+        ai_registry_put(model_id);
+        mutex_unlock(&hat_lock);
+        return resident;
     }
     
-    // Remove model from list by shifting remaining models
-    for (uint32_t i = model_index; i < num_loaded_models - 1; i++) {
-        loaded_models[i] = loaded_models[i + 1];
+    uint32_t input_size = frame_size(entry->desc.input_dims);
+    uint32_t output_size = frame_size(entry->desc.output_dims);
+    bool stage_input = !input_dma_ready(input, input_size);
+    bool stage_output = !dma_rx_safe(output, output_size);
+    
+    size_t need = (stage_input ? input_size + CACHE_LINE_SIZE : 0) +
+                  (stage_output ? line_align(output_size) + CACHE_LINE_SIZE : 0);
+    if (need > scratch->size) {
+        arena_destroy(scratch);
+        arena_init(scratch, need);
     }
     
-    num_loaded_models--;
+    const void* in = input;
+    void* out = output;
+    if (stage_input) {
+        void* copy = arena_alloc(scratch, input_size, CACHE_LINE_SIZE);
+        if (copy != NULL) {
+            memcpy(copy, input, input_size);
+            in = copy;
+        }
+    }
+    if (stage_output) {
+        // Whole lines, so no later allocation shares the output's last one
+        void* copy = arena_alloc(scratch, line_align(output_size), CACHE_LINE_SIZE);
+        if (copy != NULL) {
+            out = copy;
+        }
+    }
+    
+    // Run inference on AI HAT+
+    ai_hat_status_t status = ai_hat_run_inference(entry->hat_id, in, input_size, out, output_size);
+    
+    if (status == AI_HAT_SUCCESS && out != output) {
+        memcpy(output, out, output_size);
+    }
+    
+    // Drop every scratch allocation made on behalf of this request
+    arena_reset(scratch);
+    
+    ai_registry_put(model_id);
+    mutex_unlock(&hat_lock);
+    
+    if (status != AI_HAT_SUCCESS) {
+        return AI_SUBSYSTEM_ERROR_INFERENCE;
+    }
     
     return AI_SUBSYSTEM_SUCCESS;
 }
@@ -223,32 +624,52 @@ ai_subsystem_status_t ai_subsystem_run_inference(uint32_t model_id, const void*
         return AI_SUBSYSTEM_ERROR_PARAM;
     }
     
-    // Find model in list
-    int model_index = -1;
-    for (uint32_t i = 0; i < num_loaded_models; i++) {
-        if (loaded_models[i].id == model_id) {
-            model_index = i;
-            break;
-        }
+    return execute_inference(model_id, input, output, &caller_arena);
+}
+
+// Run inference on a batch of frames
+ai_subsystem_status_t ai_subsystem_run_inference_batch(uint32_t model_id, const void* const* inputs,
+                                                       void* const* outputs, uint32_t batch) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
     }
     
-    if (model_index == -1) {
+    if (inputs == NULL || outputs == NULL || batch == 0) {
         return AI_SUBSYSTEM_ERROR_PARAM;
     }
     
-    // Calculate input and output sizes
-    uint32_t input_size = loaded_models[model_index].input_dims[0] *
-                         loaded_models[model_index].input_dims[1] *
-                         loaded_models[model_index].input_dims[2] *
-                         loaded_models[model_index].input_dims[3];
+    mutex_lock(&hat_lock);
     
-    uint32_t output_size = loaded_models[model_index].output_dims[0] *
-                          loaded_models[model_index].output_dims[1] *
-                          loaded_models[model_index].output_dims[2] *
-                          loaded_models[model_index].output_dims[3];
+    ai_model_entry_t* entry = get_model(model_id);
+    if (entry == NULL) {
+        mutex_unlock(&hat_lock);
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
     
-    // Run inference on AI HAT+
-    ai_hat_status_t status = ai_hat_run_inference(model_id, input, input_size, output, output_size);
+    ai_subsystem_status_t resident = make_resident(entry);
+    if (resident != AI_SUBSYSTEM_SUCCESS) {
+        ai_registry_put(model_id);
+        mutex_unlock(&hat_lock);
+        return resident;
+    }
+    
+    uint32_t input_size = frame_size(entry->desc.input_dims);
+    uint32_t output_size = frame_size(entry->desc.output_dims);
+    
+    // One transfer and launch per AI_HAT_MAX_BATCH frames
+    ai_hat_status_t status = AI_HAT_SUCCESS;
+    for (uint32_t done = 0; done < batch && status == AI_HAT_SUCCESS; done += AI_HAT_MAX_BATCH) {
+        uint32_t n = batch - done < AI_HAT_MAX_BATCH ? batch - done : AI_HAT_MAX_BATCH;
+        status = ai_hat_run_inference_batch(entry->hat_id, inputs + done, input_size,
+                                            outputs + done, output_size, n);
+    }
+    
+    ai_registry_put(model_id);
+    mutex_unlock(&hat_lock);
+    
+    if (status == AI_HAT_ERROR_PARAM) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
     if (status != AI_HAT_SUCCESS) {
         return AI_SUBSYSTEM_ERROR_INFERENCE;
     }
@@ -256,6 +677,394 @@ ai_subsystem_status_t ai_subsystem_run_inference(uint32_t model_id, const void*
     return AI_SUBSYSTEM_SUCCESS;
 }
 
+// Allocate zero-copy tensors for a model
+ai_subsystem_status_t ai_subsystem_buffer_create(uint32_t model_id, ai_io_buffer_t* buffer) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (buffer == NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    mutex_lock(&hat_lock);
+    ai_model_entry_t* entry = get_model(model_id);
+    if (entry == NULL) {
+        mutex_unlock(&hat_lock);
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    // Output starts on its own cache line, so invalidating it for the
+    // download never touches input bytes
+    uint32_t input_size = frame_size(entry->desc.input_dims);
+    uint32_t output_size = frame_size(entry->desc.output_dims);
+    ai_registry_put(model_id);
+    mutex_unlock(&hat_lock);
+    size_t output_offset = ((size_t)input_size + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    size_t bytes = output_offset + output_size;
+    
+    uint8_t* block = (uint8_t*)page_alloc(page_order_for_size(bytes));
+    if (block == NULL) {
+        return AI_SUBSYSTEM_ERROR_MEMORY;
+    }
+    if (!dma_addressable(block, bytes)) {
+        page_free(block);
+        return AI_SUBSYSTEM_ERROR_MEMORY;
+    }
+    
+    buffer->model_id = model_id;
+    buffer->input = block;
+    buffer->output = block + output_offset;
+    buffer->input_size = input_size;
+    buffer->output_size = output_size;
+    buffer->block = block;
+    
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Release zero-copy tensors
+void ai_subsystem_buffer_destroy(ai_io_buffer_t* buffer) {
+    if (buffer == NULL || buffer->block == NULL) {
+        return;
+    }
+    
+    page_free(buffer->block);
+    memset(buffer, 0, sizeof(ai_io_buffer_t));
+}
+
+// Run inference in place on zero-copy tensors
+ai_subsystem_status_t ai_subsystem_run_buffer(const ai_io_buffer_t* buffer) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (buffer == NULL || buffer->block == NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    return execute_inference(buffer->model_id, buffer->input, buffer->output, &caller_arena);
+}
+
+// Start a streaming pipeline on a loaded model
+ai_subsystem_status_t ai_subsystem_pipeline_begin(ai_pipeline_t* pipeline, uint32_t model_id) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (pipeline == NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    mutex_lock(&hat_lock);
+    
+    ai_model_entry_t* entry = get_model(model_id);
+    if (entry == NULL) {
+        mutex_unlock(&hat_lock);
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    ai_subsystem_status_t resident = make_resident(entry);
+    if (resident != AI_SUBSYSTEM_SUCCESS) {
+        ai_registry_put(model_id);
+        mutex_unlock(&hat_lock);
+        return resident;
+    }
+    
+    memset(pipeline, 0, sizeof(ai_pipeline_t));
+    pipeline->model_id = model_id;
+    pipeline->hat_id = entry->hat_id;
+    pipeline->input_size = frame_size(entry->desc.input_dims);
+    pipeline->output_size = frame_size(entry->desc.output_dims);
+    
+    ai_registry_put(model_id);
+    mutex_unlock(&hat_lock);
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Upload input (or nothing) and download the oldest frame in flight once
+// the pipeline is full (or draining)
+static ai_subsystem_status_t pipeline_step(ai_pipeline_t* pipeline, const void* input, void** completed) {
+    mutex_lock(&hat_lock);
+    
+    // Frames in flight live on the HAT; they are lost if the model left it
+    ai_model_entry_t* entry = get_model(pipeline->model_id);
+    if (entry == NULL) {
+        mutex_unlock(&hat_lock);
+        return AI_SUBSYSTEM_ERROR_MODEL;
+    }
+    bool current = entry->resident && entry->hat_id == pipeline->hat_id;
+    if (current) {
+        lru_touch(entry);
+    }
+    ai_registry_put(pipeline->model_id);
+    if (!current) {
+        mutex_unlock(&hat_lock);
+        return AI_SUBSYSTEM_ERROR_MODEL;
+    }
+    
+    bool full = pipeline->head - pipeline->tail == AI_PIPELINE_DEPTH;
+    void* output = NULL;
+    if (input == NULL ? pipeline->head != pipeline->tail : full) {
+        output = pipeline->outputs[pipeline->tail % AI_PIPELINE_DEPTH];
+    }
+    
+    uint64_t start = ktime_get_ns();
+    if (pipeline->stats.steps > 0) {
+        pipeline->stats.host_ns += start - pipeline->last_step_end;
+    }
+    
+    uint32_t compute_ns = 0;
+    ai_hat_status_t status = ai_hat_pipeline_step(pipeline->hat_id, input, pipeline->input_size,
+                                                  output, pipeline->output_size, &compute_ns);
+    
+    mutex_unlock(&hat_lock);
+    
+    pipeline->last_step_end = ktime_get_ns();
+    uint64_t step_ns = pipeline->last_step_end - start;
+    pipeline->stats.transfer_ns += step_ns;
+    pipeline->stats.steps++;
+    
+    if (status != AI_HAT_SUCCESS) {
+        return status == AI_HAT_ERROR_PARAM ? AI_SUBSYSTEM_ERROR_PARAM : AI_SUBSYSTEM_ERROR_INFERENCE;
+    }
+    
+    // Inputs and outputs share the clock, so each direction is charged
+    // the step time in proportion to the bytes it moved; the overlap
+    // counts in both
+    uint32_t tx_len = input != NULL ? pipeline->input_size : 0;
+    uint32_t rx_len = output != NULL ? pipeline->output_size : 0;
+    uint32_t clocked = tx_len > rx_len ? tx_len : rx_len;
+    if (clocked > 0) {
+        pipeline->stats.upload_ns += step_ns * tx_len / clocked;
+        pipeline->stats.download_ns += step_ns * rx_len / clocked;
+    }
+    
+    if (input != NULL) {
+        pipeline->stats.frames_in++;
+        pipeline->stats.upload_bytes += pipeline->input_size;
+    }
+    if (output != NULL) {
+        pipeline->tail++;
+        pipeline->stats.frames_out++;
+        pipeline->stats.download_bytes += pipeline->output_size;
+        pipeline->stats.compute_ns += compute_ns;
+    }
+    
+    *completed = output;
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Push one frame through the pipeline
+ai_subsystem_status_t ai_subsystem_pipeline_push(ai_pipeline_t* pipeline, const void* input, void* output,
+                                                 void** completed) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (pipeline == NULL || input == NULL || output == NULL || completed == NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    ai_subsystem_status_t status = pipeline_step(pipeline, input, completed);
+    if (status != AI_SUBSYSTEM_SUCCESS) {
+        return status;
+    }
+    
+    // The slot just downloaded (if any) takes the new frame
+    pipeline->outputs[pipeline->head % AI_PIPELINE_DEPTH] = output;
+    pipeline->head++;
+    
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Collect one remaining output from the pipeline
+ai_subsystem_status_t ai_subsystem_pipeline_drain(ai_pipeline_t* pipeline, void** completed) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (pipeline == NULL || completed == NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    if (pipeline->head == pipeline->tail) {
+        *completed = NULL;
+        return AI_SUBSYSTEM_SUCCESS;
+    }
+    
+    return pipeline_step(pipeline, NULL, completed);
+}
+
+// Hand a finished request to its callback or the completion ring
+static void complete_request(const ai_request_t* req, ai_subsystem_status_t status) {
+    ai_completion_t cqe = {
+        .user_data = req->user_data,
+        .model_id = req->model_id,
+        .status = status
+    };
+    
+    if (req->callback != NULL) {
+        req->callback(&cqe);
+        
+        unsigned long flags = irq_save();
+        spin_lock(&ring_lock);
+        outstanding--;
+        pending--;
+        spin_unlock(&ring_lock);
+        irq_restore(flags);
+        return;
+    }
+    
+    unsigned long flags = irq_save();
+    spin_lock(&ring_lock);
+    cq[cq_tail & AI_RING_MASK] = cqe;
+    cq_tail++;
+    pending--;
+    thread_t* waiter = reap_waiter;
+    spin_unlock(&ring_lock);
+    irq_restore(flags);
+    
+    if (waiter != NULL) {
+        thread_wake(waiter);
+    }
+}
+
+// Worker thread draining the submission ring
+static void ai_worker_main(void* arg) {
+    (void)arg;
+    
+    // Kept for the worker's lifetime and reset after every request
+    arena_t scratch = { 0 };
+    
+    while (1) {
+        unsigned long flags = irq_save();
+        spin_lock(&ring_lock);
+        if (sq_head == sq_tail) {
+            spin_unlock(&ring_lock);
+            irq_restore(flags);
+            // ai_submit() wakes us; a wake-up racing with this is kept pending
+            thread_block();
+            continue;
+        }
+        ai_request_t req = sq[sq_head & AI_RING_MASK];
+        sq_head++;
+        spin_unlock(&ring_lock);
+        irq_restore(flags);
+        
+        complete_request(&req, execute_inference(req.model_id, req.input, req.output, &scratch));
+    }
+}
+
+// Queue inference requests for the AI worker thread
+ai_subsystem_status_t ai_submit(const ai_request_t* requests, uint32_t count, uint32_t* submitted) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (requests == NULL || submitted == NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    *submitted = 0;
+    
+    // Without a worker, run requests here; completions still go through
+    // the callback or the completion ring
+    if (ai_worker == NULL) {
+        for (uint32_t i = 0; i < count; i++) {
+            const ai_request_t* req = &requests[i];
+            if (req->input == NULL || req->output == NULL || !model_exists(req->model_id)) {
+                break;
+            }
+            
+            unsigned long flags = irq_save();
+            spin_lock(&ring_lock);
+            bool full = outstanding == AI_RING_ENTRIES;
+            if (!full) {
+                outstanding++;
+                pending++;
+                polled += req->callback == NULL;
+            }
+            spin_unlock(&ring_lock);
+            irq_restore(flags);
+            if (full) {
+                break;
+            }
+            
+            complete_request(req, execute_inference(req->model_id, req->input, req->output, &caller_arena));
+            (*submitted)++;
+        }
+        return *submitted == count ? AI_SUBSYSTEM_SUCCESS : AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    uint32_t queued = 0;
+    unsigned long flags = irq_save();
+    spin_lock(&ring_lock);
+    for (; queued < count && outstanding < AI_RING_ENTRIES; queued++) {
+        const ai_request_t* req = &requests[queued];
+        if (req->input == NULL || req->output == NULL || !model_exists(req->model_id)) {
+            break;
+        }
+        sq[sq_tail & AI_RING_MASK] = *req;
+        sq_tail++;
+        outstanding++;
+        pending++;
+        polled += req->callback == NULL;
+    }
+    spin_unlock(&ring_lock);
+    irq_restore(flags);
+    
+    if (queued > 0) {
+        thread_wake(ai_worker);
+    }
+    
+    *submitted = queued;
+    return queued == count ? AI_SUBSYSTEM_SUCCESS : AI_SUBSYSTEM_ERROR_PARAM;
+}
+
+// Take completions off the completion ring
+ai_subsystem_status_t ai_reap(ai_completion_t* completions, uint32_t max_completions,
+                              uint32_t min_completions, uint32_t* reaped) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (completions == NULL || reaped == NULL || min_completions > max_completions) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    unsigned long flags = irq_save();
+    spin_lock(&ring_lock);
+    
+    // Never wait for more than can still arrive
+    if (min_completions > polled) {
+        min_completions = polled;
+    }
+    
+    while (cq_tail - cq_head < min_completions) {
+        reap_waiter = thread_current();
+        spin_unlock(&ring_lock);
+        irq_restore(flags);
+        thread_block();
+        flags = irq_save();
+        spin_lock(&ring_lock);
+    }
+    reap_waiter = NULL;
+    
+    uint32_t count = 0;
+    while (count < max_completions && cq_head != cq_tail) {
+        completions[count++] = cq[cq_head & AI_RING_MASK];
+        cq_head++;
+    }
+    outstanding -= count;
+    polled -= count;
+    
+    spin_unlock(&ring_lock);
+    irq_restore(flags);
+    
+    *reaped = count;
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
 // Get list of loaded models
 ai_subsystem_status_t ai_subsystem_get_models(ai_model_descriptor_t* models, uint32_t max_models, uint32_t* num_models) {
     if (!ai_subsystem_initialized) {
@@ -267,16 +1076,43 @@ ai_subsystem_status_t ai_subsystem_get_models(ai_model_descriptor_t* models, uin
     }
     
     // Copy models to output
-    uint32_t count = (num_loaded_models < max_models) ? num_loaded_models : max_models;
-    for (uint32_t i = 0; i < count; i++) {
-        models[i] = loaded_models[i];
+    uint32_t count = 0;
+    uint32_t cursor = 0;
+    uint32_t model_id;
+    ai_model_entry_t* entry;
+    mutex_lock(&hat_lock);
+    while (count < max_models &&
+           (entry = (ai_model_entry_t*)ai_registry_next(AI_REGISTRY_MODEL, &cursor, &model_id)) != NULL) {
+        models[count++] = entry->desc;
+        ai_registry_put(model_id);
     }
+    mutex_unlock(&hat_lock);
     
     *num_models = count;
     
     return AI_SUBSYSTEM_SUCCESS;
 }
 
+// Get model residency counters
+ai_subsystem_status_t ai_subsystem_get_residency_stats(ai_residency_stats_t* stats) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (stats == NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    mutex_lock(&hat_lock);
+    *stats = residency;
+    mutex_unlock(&hat_lock);
+    
+    ai_hat_info_t info;
+    stats->capacity_bytes = ai_hat_get_info(&info) == AI_HAT_SUCCESS ? info.memory_size : 0;
+    
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
 // Get AI subsystem temperature
 ai_subsystem_status_t ai_subsystem_get_temperature(uint32_t* temperature) {
     if (!ai_subsystem_initialized) {
@@ -287,7 +1123,7 @@ ai_subsystem_status_t ai_subsystem_get_temperature(uint32_t* temperature) {
         return AI_SUBSYSTEM_ERROR_PARAM;
     }
     
-    // Get temperature from AI HAT+
+    // Latest telemetry sample from the AI HAT+ (no bus traffic)
     ai_hat_status_t status = ai_hat_get_temperature(temperature);
     if (status != AI_HAT_SUCCESS) {
         return AI_SUBSYSTEM_ERROR_INIT;
@@ -306,7 +1142,7 @@ ai_subsystem_status_t ai_subsystem_get_power_consumption(uint32_t* power) {
         return AI_SUBSYSTEM_ERROR_PARAM;
     }
     
-    // Get power consumption from AI HAT+
+    // Latest telemetry sample from the AI HAT+ (no bus traffic)
     ai_hat_status_t status = ai_hat_get_power_consumption(power);
     if (status != AI_HAT_SUCCESS) {
         return AI_SUBSYSTEM_ERROR_INIT;
@@ -315,6 +1151,20 @@ ai_subsystem_status_t ai_subsystem_get_power_consumption(uint32_t* power) {
     return AI_SUBSYSTEM_SUCCESS;
 }
 
+// Set AI subsystem telemetry sampling period
+ai_subsystem_status_t ai_subsystem_set_telemetry_period(uint32_t period_ms) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    ai_hat_status_t status = ai_hat_set_telemetry_period(period_ms);
+    if (status != AI_HAT_SUCCESS) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
 // Set AI subsystem power mode
 ai_subsystem_status_t ai_subsystem_set_power_mode(ai_hat_power_mode_t mode) {
     if (!ai_subsystem_initialized) {
@@ -336,9 +1186,17 @@ void ai_subsystem_shutdown(void) {
         return;
     }
     
+    // Let queued requests finish before their models go away
+    while (__atomic_load_n(&pending, __ATOMIC_ACQUIRE) != 0) {
+        sched_yield();
+    }
+    
     // Unload all models
-    while (num_loaded_models > 0) {
-        ai_subsystem_unload_model(loaded_models[0].id);
+    uint32_t cursor = 0;
+    uint32_t model_id;
+    while (ai_registry_next(AI_REGISTRY_MODEL, &cursor, &model_id) != NULL) {
+        ai_registry_put(model_id);
+        ai_subsystem_unload_model(model_id);
     }
     
     // Shutdown AI HAT+
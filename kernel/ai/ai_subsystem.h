@@ -19,7 +19,8 @@ typedef enum {
     AI_SUBSYSTEM_ERROR_MEMORY = -2,
     AI_SUBSYSTEM_ERROR_MODEL = -3,
     AI_SUBSYSTEM_ERROR_INFERENCE = -4,
-    AI_SUBSYSTEM_ERROR_PARAM = -5
+    AI_SUBSYSTEM_ERROR_PARAM = -5,
+    AI_SUBSYSTEM_ERROR_CHECKSUM = -6    // Upload restarted; rewind the reader
 } ai_subsystem_status_t;
 
 // AI model type
@@ -36,36 +37,180 @@ typedef struct {
     char name[32];
     uint32_t id;
     ai_model_type_t type;
-    uint32_t input_dims[4];  // [batch, height, width, channels]
+    uint32_t input_dims[4];  // [batch, height, width, channels], one frame per batch entry
     uint32_t output_dims[4]; // [batch, height, width, channels]
     ai_hat_precision_t precision;
 } ai_model_descriptor_t;
 
+// Entries in the asynchronous submission and completion rings. Bounds the
+// number of requests submitted but not yet completed and reaped.
+#define AI_RING_ENTRIES 32
+
+struct ai_completion;
+
+// Completion callback, run on the AI worker thread instead of posting to
+// the completion ring
+typedef void (*ai_completion_cb_t)(const struct ai_completion* cqe);
+
+// Asynchronous inference request
+typedef struct {
+    uint32_t model_id;
+    const void* input;
+    void* output;
+    ai_completion_cb_t callback;    // NULL: post to the completion ring
+    void* user_data;                // Handed back in the completion
+} ai_request_t;
+
+// Completed asynchronous inference request
+typedef struct ai_completion {
+    void* user_data;
+    uint32_t model_id;
+    ai_subsystem_status_t status;
+} ai_completion_t;
+
+// Frames a pipeline holds between upload and download
+#define AI_PIPELINE_DEPTH 2
+
+// Per-stage counters of a streaming pipeline
+typedef struct {
+    uint64_t frames_in;         // Frames uploaded
+    uint64_t frames_out;        // Outputs downloaded
+    uint64_t steps;             // SPI transfers, each overlapping upload and download
+    uint64_t upload_bytes;
+    uint64_t download_bytes;
+    uint64_t transfer_ns;       // Bus time of all steps
+    uint64_t upload_ns;         // Share of transfer_ns spent clocking inputs out
+    uint64_t download_ns;       // Share of transfer_ns spent clocking outputs in
+    uint64_t compute_ns;        // HAT compute time of the frames downloaded
+    uint64_t host_ns;           // Time between steps spent by the caller
+} ai_pipeline_stats_t;
+
+// Streaming inference pipeline. Frame N+1 uploads while the AI HAT+
+// computes frame N and frame N-1's output downloads.
+typedef struct {
+    uint32_t model_id;
+    uint32_t hat_id;                    // Model's ID on the HAT when the pipeline began
+    uint32_t input_size;
+    uint32_t output_size;
+    void* outputs[AI_PIPELINE_DEPTH];   // Output buffers of frames in flight
+    uint32_t head;                      // Frames pushed
+    uint32_t tail;                      // Outputs delivered
+    uint64_t last_step_end;
+    ai_pipeline_stats_t stats;
+} ai_pipeline_t;
+
+// Model residency on the AI HAT+. Models that do not fit evict the least
+// recently used ones, which reload from their source on next use.
+typedef struct {
+    uint64_t hits;              // Uses of a resident model
+    uint64_t misses;            // Uses that had to reload the model
+    uint64_t evictions;
+    uint32_t resident_models;
+    uint32_t resident_bytes;
+    uint32_t capacity_bytes;    // ai_hat_info_t.memory_size
+} ai_residency_stats_t;
+
+// Input and output tensors of one model in memory the AI HAT+ can DMA
+// from and to directly. Producers fill input in place and consumers read
+// output in place. Only an output that ends mid cache line is staged,
+// since DMA may only write whole lines.
+typedef struct {
+    uint32_t model_id;
+    void* input;
+    void* output;
+    uint32_t input_size;        // Bytes in one input frame
+    uint32_t output_size;       // Bytes in one output frame
+    void* block;                // Backing pages
+} ai_io_buffer_t;
+
 // Initialize the AI subsystem
 ai_subsystem_status_t ai_subsystem_init(void);
 
 // Get AI subsystem information
 ai_subsystem_status_t ai_subsystem_get_info(ai_hat_info_t* info);
 
-// Load a model from memory
+// Load a model from memory. model_data must stay valid until the model is
+// unloaded: it is read again if the model is evicted and reloaded.
 ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t model_size, 
                                              ai_model_type_t type, ai_model_descriptor_t* descriptor);
 
+// Start a streamed upload of a model_size byte model, evicting resident
+// models if it does not fit
+ai_subsystem_status_t ai_subsystem_upload_init(ai_hat_upload_t* upload, uint32_t model_size);
+
+// Stream a model from reader in checksummed chunks; upload comes from
+// ai_subsystem_upload_init(). After a failure, call again with the same
+// upload to resume, or release it with ai_hat_upload_abort(). After
+// AI_SUBSYSTEM_ERROR_CHECKSUM the upload resumes from offset 0. reader and
+// ctx are kept to reload the model after an eviction, so reader must be
+// able to start again from offset 0.
+ai_subsystem_status_t ai_subsystem_load_model_stream(ai_hat_upload_t* upload, ai_hat_model_reader_t reader, void* ctx,
+                                                    ai_model_type_t type, ai_model_descriptor_t* descriptor);
+
 // Unload a model
 ai_subsystem_status_t ai_subsystem_unload_model(uint32_t model_id);
 
 // Run inference on a loaded model
 ai_subsystem_status_t ai_subsystem_run_inference(uint32_t model_id, const void* input, void* output);
 
+// Run inference on batch frames, one input and one output buffer per frame,
+// sized by the descriptor's height * width * channels. Up to
+// AI_HAT_MAX_BATCH frames share one transfer and launch on the AI HAT+.
+ai_subsystem_status_t ai_subsystem_run_inference_batch(uint32_t model_id, const void* const* inputs,
+                                                       void* const* outputs, uint32_t batch);
+
+// Start a streaming pipeline on a loaded model
+ai_subsystem_status_t ai_subsystem_pipeline_begin(ai_pipeline_t* pipeline, uint32_t model_id);
+
+// Push one frame; its output lands in output AI_PIPELINE_DEPTH pushes
+// later. *completed gets the output buffer filled by this step, or NULL
+// while the pipeline fills.
+ai_subsystem_status_t ai_subsystem_pipeline_push(ai_pipeline_t* pipeline, const void* input, void* output,
+                                                 void** completed);
+
+// Collect one remaining output without pushing a frame. *completed gets
+// the filled buffer, or NULL once the pipeline is empty.
+ai_subsystem_status_t ai_subsystem_pipeline_drain(ai_pipeline_t* pipeline, void** completed);
+
+// Allocate zero-copy input and output tensors for a loaded model. The
+// buffers are cache-line aligned and DMA-addressable, so transfers take
+// the DMA path in place unless output_size is not a whole number of
+// cache lines.
+ai_subsystem_status_t ai_subsystem_buffer_create(uint32_t model_id, ai_io_buffer_t* buffer);
+
+// Release buffers from ai_subsystem_buffer_create()
+void ai_subsystem_buffer_destroy(ai_io_buffer_t* buffer);
+
+// Run inference on a buffer's input tensor into its output tensor
+ai_subsystem_status_t ai_subsystem_run_buffer(const ai_io_buffer_t* buffer);
+
+// Queue inference requests for the AI worker thread, which runs them in
+// submission order. Queues requests up to the first invalid one or until
+// AI_RING_ENTRIES requests are outstanding; *submitted gets the count.
+ai_subsystem_status_t ai_submit(const ai_request_t* requests, uint32_t count, uint32_t* submitted);
+
+// Take up to max_completions completions off the completion ring, first
+// sleeping until at least min_completions are available (clamped to the
+// number still outstanding). One thread at a time may sleep here.
+// *reaped gets the count.
+ai_subsystem_status_t ai_reap(ai_completion_t* completions, uint32_t max_completions,
+                              uint32_t min_completions, uint32_t* reaped);
+
 // Get list of loaded models
 ai_subsystem_status_t ai_subsystem_get_models(ai_model_descriptor_t* models, uint32_t max_models, uint32_t* num_models);
 
+// Get model residency counters
+ai_subsystem_status_t ai_subsystem_get_residency_stats(ai_residency_stats_t* stats);
+
 // Get AI subsystem temperature
 ai_subsystem_status_t ai_subsystem_get_temperature(uint32_t* temperature);
 
 // Get AI subsystem power consumption
 ai_subsystem_status_t ai_subsystem_get_power_consumption(uint32_t* power);
 
+// Set AI subsystem telemetry sampling period (in ms)
+ai_subsystem_status_t ai_subsystem_set_telemetry_period(uint32_t period_ms);
+
 // Set AI subsystem power mode
 ai_subsystem_status_t ai_subsystem_set_power_mode(ai_hat_power_mode_t mode);
 
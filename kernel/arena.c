@@ -0,0 +1,68 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "arena.h"
+#include "memory.h"
+
+// Back an arena with at least size bytes from the page allocator
+bool arena_init(arena_t* arena, size_t size) {
+    if (arena == NULL || size == 0) {
+        return false;
+    }
+
+    unsigned int order = page_order_for_size(size);
+    if (order >= MAX_ORDER) {
+        return false;
+    }
+
+    arena->base = (uint8_t*)page_alloc(order);
+    if (arena->base == NULL) {
+        return false;
+    }
+
+    arena->size = PAGE_SIZE << order;
+    arena->offset = 0;
+    arena->high_water = 0;
+    arena->failures = 0;
+    return true;
+}
+
+// Return the arena's pages to the page allocator
+void arena_destroy(arena_t* arena) {
+    if (arena == NULL || arena->base == NULL) {
+        return;
+    }
+
+    page_free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->offset = 0;
+}
+
+// Allocate size bytes by bumping the offset
+void* arena_alloc(arena_t* arena, size_t size, size_t align) {
+    if (arena == NULL || arena->base == NULL) {
+        return NULL;
+    }
+
+    if (align == 0) {
+        align = ARENA_DEFAULT_ALIGN;
+    }
+
+    size_t start = (arena->offset + align - 1) & ~(align - 1);
+    if (start > arena->size || size > arena->size - start) {
+        arena->failures++;
+        return NULL;
+    }
+
+    arena->offset = start + size;
+    if (arena->offset > arena->high_water) {
+        arena->high_water = arena->offset;
+    }
+
+    return arena->base + start;
+}
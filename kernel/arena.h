@@ -0,0 +1,56 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "types.h"
+#include <stdbool.h>
+
+// Default alignment for arena allocations
+#define ARENA_DEFAULT_ALIGN 16
+
+// Bump allocator over a contiguous block of pages. Allocations are never
+// freed individually; arena_reset() releases everything at once. An arena
+// takes no lock: it belongs to the one context running a request, which
+// passes it down and resets it when the request is done.
+typedef struct {
+    uint8_t* base;
+    size_t size;
+    size_t offset;
+    size_t high_water;
+    uint32_t failures;
+} arena_t;
+
+// Back an arena with at least size bytes from the page allocator
+bool arena_init(arena_t* arena, size_t size);
+
+// Return the arena's pages to the page allocator
+void arena_destroy(arena_t* arena);
+
+// Allocate size bytes aligned to align (a power of two, 0 for the default)
+void* arena_alloc(arena_t* arena, size_t size, size_t align);
+
+// Current allocation offset, for scoped release with arena_release()
+static inline size_t arena_mark(const arena_t* arena) {
+    return arena->offset;
+}
+
+// Release everything allocated after a mark
+static inline void arena_release(arena_t* arena, size_t mark) {
+    if (mark <= arena->offset) {
+        arena->offset = mark;
+    }
+}
+
+// Release every allocation in O(1)
+static inline void arena_reset(arena_t* arena) {
+    arena->offset = 0;
+}
+
+#endif // ARENA_H
@@ -0,0 +1,462 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "bench.h"
+#include "irq.h"
+#include "memory.h"
+#include "mmu.h"
+#include "sched.h"
+#include "stdio.h"
+#include "timer.h"
+#include "types.h"
+#include <stdbool.h>
+#include "../drivers/uart.h"
+#include "ai/ai_subsystem.h"
+
+// Bytes moved per measurement, split into copies of the tested size
+#define BENCH_BYTES_PER_RUN (8 * 1024 * 1024)
+
+// Bytes moved per size with the MMU and caches off, where copies are far slower
+#define BENCH_BYTES_MMU_OFF (1024 * 1024)
+
+// Convert bytes moved in ns to MB/s
+static uint64_t bench_mbps(uint64_t bytes, uint64_t ns) {
+    return (bytes * NSEC_PER_SEC / (ns ? ns : 1)) >> 20;
+}
+
+// Time memcpy at each size, moving about total bytes per size; MB/s goes to mbps
+static void bench_memcpy_pass(uint8_t* dst, const uint8_t* src, const uint32_t* sizes,
+                              unsigned int count, uint32_t total, uint64_t* mbps) {
+    for (unsigned int i = 0; i < count; i++) {
+        uint32_t size = sizes[i];
+        uint32_t iterations = total / size ? total / size : 1;
+
+        uint64_t start = ktime_get_ns();
+        for (uint32_t n = 0; n < iterations; n++) {
+            memcpy(dst, src, size);
+        }
+        uint64_t end = ktime_get_ns();
+
+        mbps[i] = bench_mbps((uint64_t)iterations * size, end - start);
+    }
+}
+
+// Measure memcpy throughput over a range of copy sizes, with the MMU and
+// caches on and, where this core can turn them off, off again
+void bench_memcpy() {
+    static const uint32_t sizes[] = { 64, 512, 4096, 65536, 1024 * 1024 };
+    const unsigned int count = sizeof(sizes) / sizeof(sizes[0]);
+    uint64_t on[sizeof(sizes) / sizeof(sizes[0])];
+    uint64_t off[sizeof(sizes) / sizeof(sizes[0])];
+    unsigned int order = page_order_for_size(1024 * 1024);
+
+    uint8_t* src = (uint8_t*)page_alloc(order);
+    uint8_t* dst = (uint8_t*)page_alloc(order);
+    if (src == NULL || dst == NULL) {
+        uart_puts("bench: out of memory\n");
+        page_free(src);
+        page_free(dst);
+        return;
+    }
+
+    memset(src, 0x5A, PAGE_SIZE << order);
+
+    // Both passes run with interrupts masked so they take the same memcpy
+    // path, and so nothing can interrupt the pass with the MMU off
+    bool mmu_on = mmu_enabled();
+    unsigned long flags = irq_save();
+    bench_memcpy_pass(dst, src, sizes, count, BENCH_BYTES_PER_RUN, on);
+    if (mmu_on) {
+        // Rerun the sweep the way the kernel ran before boot enabled the MMU
+        mmu_disable();
+        bench_memcpy_pass(dst, src, sizes, count, BENCH_BYTES_MMU_OFF, off);
+        mmu_enable();
+    }
+    irq_restore(flags);
+
+    if (mmu_on) {
+        uart_puts("memcpy benchmark (MMU and caches on -> off, MB/s):\n");
+        for (unsigned int i = 0; i < count; i++) {
+            uart_printf("  memcpy %d bytes: %d -> %d\n", (int)sizes[i], (int)on[i], (int)off[i]);
+        }
+    } else {
+        uart_puts("memcpy benchmark (MMU and caches off, MB/s):\n");
+        for (unsigned int i = 0; i < count; i++) {
+            uart_printf("  memcpy %d bytes: %d\n", (int)sizes[i], (int)on[i]);
+        }
+    }
+
+    page_free(src);
+    page_free(dst);
+}
+
+// Enable the cycle counter on the calling core
+static void bench_cycles_init() {
+#if defined(__aarch64__)
+    uint64_t pmcr;
+    asm volatile("mrs %0, pmcr_el0" : "=r"(pmcr));
+    asm volatile("msr pmcr_el0, %0\n"
+                 "msr pmccfiltr_el0, xzr\n"
+                 "msr pmcntenset_el0, %1\n"
+                 "isb" :: "r"(pmcr | 1), "r"(1UL << 31) : "memory");
+#endif
+}
+
+// Read the CPU cycle counter
+static inline uint64_t bench_cycles() {
+#if defined(__aarch64__)
+    uint64_t cycles;
+    asm volatile("isb\n"
+                 "mrs %0, pmccntr_el0" : "=r"(cycles) :: "memory");
+    return cycles;
+#elif defined(__x86_64__)
+    uint32_t lo, hi;
+    asm volatile("lfence\n"
+                 "rdtsc" : "=a"(lo), "=d"(hi) :: "memory");
+    return ((uint64_t)hi << 32) | lo;
+#elif defined(__riscv)
+    uint64_t cycles;
+    asm volatile("rdcycle %0" : "=r"(cycles));
+    return cycles;
+#else
+    return 0;
+#endif
+}
+
+// Enable the cycle counter and check that it actually counts
+static bool bench_cycles_usable() {
+    bench_cycles_init();
+    uint64_t probe = bench_cycles();
+    return bench_cycles() != probe;
+}
+
+// The byte loops memcpy/memset/memmove used to be, kept as the baseline
+#define BENCH_BASELINE __attribute__((noinline, optimize("no-tree-loop-distribute-patterns")))
+
+BENCH_BASELINE
+static void baseline_copy(void* dest, const void* src, size_t n) {
+    char* d = (char*)dest;
+    const char* s = (const char*)src;
+    for (size_t i = 0; i < n; i++) {
+        d[i] = s[i];
+    }
+}
+
+BENCH_BASELINE
+static void baseline_set(void* dest, const void* src, size_t n) {
+    (void)src;
+    unsigned char* p = (unsigned char*)dest;
+    while (n--) {
+        *p++ = 0;
+    }
+}
+
+static void opt_copy(void* dest, const void* src, size_t n) {
+    memcpy(dest, src, n);
+}
+
+static void opt_set(void* dest, const void* src, size_t n) {
+    (void)src;
+    memset(dest, 0, n);
+}
+
+static void opt_move(void* dest, const void* src, size_t n) {
+    memmove(dest, src, n);
+}
+
+typedef void (*bench_mem_fn_t)(void* dest, const void* src, size_t n);
+
+// Cycles (or nanoseconds without a cycle counter) to push
+// BENCH_BYTES_PER_RUN through fn in blocks of size bytes
+static uint64_t bench_mem_run(bench_mem_fn_t fn, uint8_t* dst, const uint8_t* src,
+                              uint32_t size, bool use_cycles) {
+    uint32_t iterations = BENCH_BYTES_PER_RUN / size;
+
+    uint64_t start = use_cycles ? bench_cycles() : ktime_get_ns();
+    for (uint32_t n = 0; n < iterations; n++) {
+        fn(dst, src, size);
+    }
+    uint64_t end = use_cycles ? bench_cycles() : ktime_get_ns();
+
+    return end > start ? end - start : 1;
+}
+
+// Print one baseline -> optimized line with the rate in bytes per unit
+static void bench_print_row(const char* name, uint32_t size, uint64_t bytes,
+                            uint64_t base, uint64_t opt, const char* unit) {
+    // Fixed point with two decimals
+    uint64_t base_rate = bytes * 100 / base;
+    uint64_t opt_rate = bytes * 100 / opt;
+    uint64_t speedup = base * 10 / opt;
+
+    uart_printf("  %-10s %8u: %3llu.%02llu -> %3llu.%02llu %s (%llu.%llux)\n",
+                name, (unsigned int)size,
+                (unsigned long long)(base_rate / 100), (unsigned long long)(base_rate % 100),
+                (unsigned long long)(opt_rate / 100), (unsigned long long)(opt_rate % 100),
+                unit,
+                (unsigned long long)(speedup / 10), (unsigned long long)(speedup % 10));
+}
+
+// Compare the word/SIMD memory routines with byte loops across sizes
+void bench_mem_sweep() {
+    static const uint32_t sizes[] = {
+        8, 16, 32, 64, 128, 256, 512, 1024, 4096, 16384, 65536, 262144, 1024 * 1024
+    };
+    static const struct {
+        const char* name;
+        bench_mem_fn_t baseline;
+        bench_mem_fn_t optimized;
+        uint32_t src_offset;
+    } cases[] = {
+        { "memcpy",         baseline_copy, opt_copy, 0 },
+        { "memcpy+1",       baseline_copy, opt_copy, 1 },
+        { "memset(0)",      baseline_set,  opt_set,  0 },
+        { "memmove",        baseline_copy, opt_move, 0 },
+    };
+
+    unsigned int order = page_order_for_size(1024 * 1024 + PAGE_SIZE);
+    uint8_t* src = (uint8_t*)page_alloc(order);
+    uint8_t* dst = (uint8_t*)page_alloc(order);
+    if (src == NULL || dst == NULL) {
+        uart_puts("bench: out of memory\n");
+        page_free(src);
+        page_free(dst);
+        return;
+    }
+    memset(src, 0x5A, PAGE_SIZE << order);
+
+    // Stay on one core so the cycle counter is consistent
+    preempt_disable();
+
+    bool use_cycles = bench_cycles_usable();
+    const char* unit = use_cycles ? "B/cycle" : "B/ns";
+
+    uart_printf("Memory routine sweep (%s, byte loop -> optimized):\n", unit);
+    for (unsigned int c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            uint32_t size = sizes[i];
+            uint64_t bytes = (uint64_t)(BENCH_BYTES_PER_RUN / size) * size;
+            const uint8_t* from = src + cases[c].src_offset;
+
+            uint64_t base = bench_mem_run(cases[c].baseline, dst, from, size, use_cycles);
+            uint64_t opt = bench_mem_run(cases[c].optimized, dst, from, size, use_cycles);
+
+            bench_print_row(cases[c].name, size, bytes, base, opt, unit);
+        }
+    }
+
+    preempt_enable();
+
+    page_free(src);
+    page_free(dst);
+}
+
+// Results of the string routines land here so calls are not optimized away
+static volatile size_t bench_sink;
+
+// The byte loops strlen/strcmp/strcpy/strncpy used to be
+BENCH_BASELINE
+static void baseline_strlen(void* dest, const void* src, size_t n) {
+    (void)dest;
+    (void)n;
+    const char* s = (const char*)src;
+    size_t len = 0;
+    while (s[len]) {
+        len++;
+    }
+    bench_sink = len;
+}
+
+BENCH_BASELINE
+static void baseline_strcmp(void* dest, const void* src, size_t n) {
+    (void)n;
+    const char* a = (const char*)dest;
+    const char* b = (const char*)src;
+    while (*a && (*a == *b)) {
+        a++;
+        b++;
+    }
+    bench_sink = *(const unsigned char*)a - *(const unsigned char*)b;
+}
+
+BENCH_BASELINE
+static void baseline_strcpy(void* dest, const void* src, size_t n) {
+    (void)n;
+    char* d = (char*)dest;
+    const char* s = (const char*)src;
+    while ((*d++ = *s++));
+}
+
+BENCH_BASELINE
+static void baseline_strncpy(void* dest, const void* src, size_t n) {
+    char* d = (char*)dest;
+    const char* s = (const char*)src;
+    size_t i;
+    for (i = 0; i < n && s[i] != '\0'; i++) {
+        d[i] = s[i];
+    }
+    for (; i < n; i++) {
+        d[i] = '\0';
+    }
+}
+
+static void opt_strlen(void* dest, const void* src, size_t n) {
+    (void)dest;
+    (void)n;
+    bench_sink = strlen((const char*)src);
+}
+
+static void opt_strcmp(void* dest, const void* src, size_t n) {
+    (void)n;
+    bench_sink = strcmp((const char*)dest, (const char*)src);
+}
+
+static void opt_strcpy(void* dest, const void* src, size_t n) {
+    (void)n;
+    strcpy((char*)dest, (const char*)src);
+}
+
+static void opt_strncpy(void* dest, const void* src, size_t n) {
+    strncpy((char*)dest, (const char*)src, n);
+}
+
+// Compare the word-at-a-time string routines with byte loops across
+// string lengths. strcmp compares two equal strings, its worst case.
+void bench_str_sweep() {
+    static const uint32_t lengths[] = { 4, 8, 16, 32, 64, 128, 256, 1024, 4096 };
+    static const struct {
+        const char* name;
+        bench_mem_fn_t baseline;
+        bench_mem_fn_t optimized;
+        uint32_t src_offset;
+    } cases[] = {
+        { "strlen",     baseline_strlen,  opt_strlen,  0 },
+        { "strlen+3",   baseline_strlen,  opt_strlen,  3 },
+        { "strcmp",     baseline_strcmp,  opt_strcmp,  0 },
+        { "strcmp+3",   baseline_strcmp,  opt_strcmp,  3 },
+        { "strcpy",     baseline_strcpy,  opt_strcpy,  0 },
+        { "strncpy",    baseline_strncpy, opt_strncpy, 0 },
+    };
+
+    uint8_t* src = (uint8_t*)page_alloc(1);
+    uint8_t* dst = (uint8_t*)page_alloc(1);
+    if (src == NULL || dst == NULL) {
+        uart_puts("bench: out of memory\n");
+        page_free(src);
+        page_free(dst);
+        return;
+    }
+
+    preempt_disable();
+
+    bool use_cycles = bench_cycles_usable();
+    const char* unit = use_cycles ? "B/cycle" : "B/ns";
+
+    uart_printf("String routine sweep (%s, byte loop -> word-at-a-time):\n", unit);
+    for (unsigned int c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (unsigned int i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+            uint32_t len = lengths[i];
+            uint64_t bytes = (uint64_t)(BENCH_BYTES_PER_RUN / len) * len;
+            uint8_t* from = src + cases[c].src_offset;
+
+            memset(from, 'a', len);
+            from[len] = '\0';
+            // strcmp reads its second string from dst; the copies overwrite it
+            memcpy(dst, from, len + 1);
+
+            uint64_t base = bench_mem_run(cases[c].baseline, dst, from, len, use_cycles);
+            uint64_t opt = bench_mem_run(cases[c].optimized, dst, from, len, use_cycles);
+
+            bench_print_row(cases[c].name, len, bytes, base, opt, unit);
+        }
+    }
+
+    preempt_enable();
+
+    page_free(src);
+    page_free(dst);
+}
+
+// Frames run per batch size in the AI benchmark
+#define BENCH_AI_FRAMES 64
+
+// Print frames per second for a run of frames
+static uint64_t bench_fps(uint32_t frames, uint64_t ns) {
+    return (uint64_t)frames * NSEC_PER_SEC / (ns ? ns : 1);
+}
+
+// Compare single-shot inference with batched inference across batch sizes
+void bench_ai_batch() {
+    static const void* inputs[BENCH_AI_FRAMES];
+    static void* outputs[BENCH_AI_FRAMES];
+
+    // A classification model: 224x224x3 in, 1000 classes out
+    uint32_t input_size = 224 * 224 * 3;
+    unsigned int in_order = page_order_for_size(input_size);
+    uint8_t* input = (uint8_t*)page_alloc(in_order);
+    uint8_t* output = (uint8_t*)page_alloc(0);
+    uint8_t* weights = (uint8_t*)page_alloc(0);
+    if (input == NULL || output == NULL || weights == NULL) {
+        uart_puts("bench: out of memory\n");
+        page_free(input);
+        page_free(output);
+        page_free(weights);
+        return;
+    }
+    memset(input, 0x5A, input_size);
+    memset(weights, 0xA5, PAGE_SIZE);
+
+    ai_model_descriptor_t model;
+    if (ai_subsystem_load_model(weights, PAGE_SIZE, AI_MODEL_TYPE_CLASSIFICATION, &model) != AI_SUBSYSTEM_SUCCESS) {
+        uart_puts("bench: failed to load a model on the AI HAT+\n");
+        page_free(input);
+        page_free(output);
+        page_free(weights);
+        return;
+    }
+
+    // Every frame reuses the same tensors; only the transfer pattern differs
+    for (uint32_t i = 0; i < BENCH_AI_FRAMES; i++) {
+        inputs[i] = input;
+        outputs[i] = output;
+    }
+
+    uart_printf("AI inference, %u frames per row (single-shot -> batched, frames/s):\n",
+                (unsigned int)BENCH_AI_FRAMES);
+    // Larger batches are split into AI_HAT_MAX_BATCH launches, so stop there
+    for (uint32_t batch = 1; batch <= AI_HAT_MAX_BATCH; batch *= 2) {
+        ai_subsystem_status_t status = AI_SUBSYSTEM_SUCCESS;
+
+        uint64_t start = ktime_get_ns();
+        for (uint32_t i = 0; i < BENCH_AI_FRAMES && status == AI_SUBSYSTEM_SUCCESS; i++) {
+            status = ai_subsystem_run_inference(model.id, input, output);
+        }
+        uint64_t single = ktime_get_ns() - start;
+
+        start = ktime_get_ns();
+        for (uint32_t i = 0; i < BENCH_AI_FRAMES && status == AI_SUBSYSTEM_SUCCESS; i += batch) {
+            status = ai_subsystem_run_inference_batch(model.id, &inputs[i], &outputs[i], batch);
+        }
+        uint64_t batched = ktime_get_ns() - start;
+
+        if (status != AI_SUBSYSTEM_SUCCESS) {
+            uart_printf("  batch %2u: inference failed (%d)\n", (unsigned int)batch, (int)status);
+            break;
+        }
+
+        uint64_t speedup = single * 10 / (batched ? batched : 1);
+        uart_printf("  batch %2u: %6llu -> %6llu (%llu.%llux)\n", (unsigned int)batch,
+                    (unsigned long long)bench_fps(BENCH_AI_FRAMES, single),
+                    (unsigned long long)bench_fps(BENCH_AI_FRAMES, batched),
+                    (unsigned long long)(speedup / 10), (unsigned long long)(speedup % 10));
+    }
+
+    ai_subsystem_unload_model(model.id);
+    page_free(input);
+    page_free(output);
+    page_free(weights);
+}
@@ -0,0 +1,27 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+// Measure memcpy throughput over a range of copy sizes, with the MMU and
+// caches on and off
+void bench_memcpy();
+
+// Compare memcpy/memset/memmove with byte loops across sizes, in bytes per
+// cycle where a cycle counter is available
+void bench_mem_sweep();
+
+// Compare strlen/strcmp/strcpy/strncpy with byte loops across string lengths
+void bench_str_sweep();
+
+// Compare single-shot and batched AI HAT+ inference throughput across
+// batch sizes
+void bench_ai_batch();
+
+#endif // BENCH_H
@@ -0,0 +1,90 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "cache.h"
+
+#if defined(__riscv)
+// Zicbom has no way to discover the block size; this matches common cores
+#define RISCV_CBO_BLOCK_SIZE 64
+
+// cbo.clean / cbo.inval / cbo.flush, encoded for assemblers without Zicbom
+#define CBO_INVAL   0
+#define CBO_CLEAN   1
+#define CBO_FLUSH   2
+#define CBO(op, p)  asm volatile(".insn i 0x0F, 2, x0, %0, " #op :: "r"(p) : "memory")
+#endif
+
+// Smallest data cache line size in bytes
+size_t dcache_line_size(void) {
+#if defined(__aarch64__)
+    uint64_t ctr;
+    asm volatile("mrs %0, ctr_el0" : "=r"(ctr));
+    return 4UL << ((ctr >> 16) & 0xF);
+#elif defined(__riscv)
+    return RISCV_CBO_BLOCK_SIZE;
+#else
+    return 64;
+#endif
+}
+
+#if defined(__aarch64__)
+// Walk the lines covering a range with one DC operation
+#define DC_RANGE(op, addr, len) do {                                    \
+        size_t line = dcache_line_size();                               \
+        uintptr_t p = (uintptr_t)(addr) & ~(line - 1);                  \
+        uintptr_t end = (uintptr_t)(addr) + (len);                      \
+        for (; p < end; p += line) {                                    \
+            asm volatile("dc " op ", %0" :: "r"(p) : "memory");         \
+        }                                                               \
+        asm volatile("dsb sy" ::: "memory");                            \
+    } while (0)
+#elif defined(__riscv)
+#define CBO_RANGE(op, addr, len) do {                                   \
+        uintptr_t p = (uintptr_t)(addr) & ~(uintptr_t)(RISCV_CBO_BLOCK_SIZE - 1); \
+        uintptr_t end = (uintptr_t)(addr) + (len);                      \
+        for (; p < end; p += RISCV_CBO_BLOCK_SIZE) {                    \
+            CBO(op, p);                                                 \
+        }                                                               \
+        asm volatile("fence rw, rw" ::: "memory");                      \
+    } while (0)
+#endif
+
+// Write dirty lines back to memory
+void dcache_clean_range(const void* addr, size_t len) {
+#if defined(__aarch64__)
+    DC_RANGE("cvac", addr, len);
+#elif defined(__riscv)
+    CBO_RANGE(CBO_CLEAN, addr, len);
+#else
+    (void)addr;
+    (void)len;
+#endif
+}
+
+// Discard lines without writing them back
+void dcache_inval_range(void* addr, size_t len) {
+#if defined(__aarch64__)
+    DC_RANGE("ivac", addr, len);
+#elif defined(__riscv)
+    CBO_RANGE(CBO_INVAL, addr, len);
+#else
+    (void)addr;
+    (void)len;
+#endif
+}
+
+// Write dirty lines back, then discard them
+void dcache_flush_range(const void* addr, size_t len) {
+#if defined(__aarch64__)
+    DC_RANGE("civac", addr, len);
+#elif defined(__riscv)
+    CBO_RANGE(CBO_FLUSH, addr, len);
+#else
+    (void)addr;
+    (void)len;
+#endif
+}
@@ -0,0 +1,32 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "types.h"
+
+// Data cache maintenance by virtual address range, to the point of
+// coherency. Ranges are widened to whole cache lines, so the lines at
+// either end are affected beyond [addr, addr + len). Each call completes
+// (with a barrier) before it returns. No-ops on x86_64, whose caches are
+// coherent with DMA.
+
+// Write dirty lines back to memory; data stays cached
+void dcache_clean_range(const void* addr, size_t len);
+
+// Discard lines without writing them back
+void dcache_inval_range(void* addr, size_t len);
+
+// Write dirty lines back, then discard them
+void dcache_flush_range(const void* addr, size_t len);
+
+// Smallest data cache line size in bytes
+size_t dcache_line_size(void);
+
+#endif // CACHE_H
@@ -0,0 +1,182 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "console.h"
+#include "irq.h"
+#include "spinlock.h"
+#include "stdio.h"
+#include "../drivers/uart.h"
+
+#define CONSOLE_MASK        (CONSOLE_BUFFER_SIZE - 1)
+
+// How long console_flush() waits for a drain in progress before taking
+// over anyway (the drainer may be the code that crashed)
+#define CONSOLE_FLUSH_SPINS 1000000
+
+// Multi-producer, single-consumer byte ring. Writers claim space by
+// advancing reserve_head with a CAS, copy their bytes, then publish them
+// by advancing commit_head in reservation order. One drainer at a time
+// (drain_busy) moves [tail, commit_head) into the UART.
+static char ring[CONSOLE_BUFFER_SIZE];
+static uint32_t reserve_head;
+static uint32_t commit_head;
+static uint32_t tail;
+static uint32_t drain_busy;
+static uint32_t dropped;
+static volatile bool buffered = false;
+
+void console_set_buffered(bool enable) {
+    buffered = enable;
+}
+
+bool console_buffered(void) {
+    return buffered;
+}
+
+// Copy into the ring at a free-running position, wrapping at the end
+static void ring_copy(uint32_t pos, const char* data, uint32_t len) {
+    uint32_t index = pos & CONSOLE_MASK;
+    uint32_t first = CONSOLE_BUFFER_SIZE - index;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&ring[index], data, first);
+    memcpy(&ring[0], data + first, len - first);
+}
+
+// Append output to the ring without waiting for the UART
+void console_write(const char* data, size_t len) {
+    if (len == 0) {
+        return;
+    }
+
+    // The UART wants CR LF; expand here so the drain copies bytes verbatim
+    uint32_t newlines = 0;
+    for (size_t i = 0; i < len; i++) {
+        newlines += (data[i] == '\n');
+    }
+    size_t total = len + newlines;
+    if (total > CONSOLE_BUFFER_SIZE) {
+        __atomic_fetch_add(&dropped, (uint32_t)total, __ATOMIC_RELAXED);
+        return;
+    }
+
+    // A writer interrupted between reserve and commit would stall every
+    // later writer on this core, including IRQ handlers
+    unsigned long flags = irq_save();
+
+    uint32_t start = __atomic_load_n(&reserve_head, __ATOMIC_RELAXED);
+    do {
+        uint32_t used = start - __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+        if (used + total > CONSOLE_BUFFER_SIZE) {
+            __atomic_fetch_add(&dropped, (uint32_t)total, __ATOMIC_RELAXED);
+            irq_restore(flags);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&reserve_head, &start, start + (uint32_t)total,
+                                          true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    if (newlines == 0) {
+        ring_copy(start, data, (uint32_t)len);
+    } else {
+        uint32_t pos = start;
+        size_t run = 0;
+        for (size_t i = 0; i < len; i++) {
+            if (data[i] == '\n') {
+                ring_copy(pos, data + run, (uint32_t)(i - run));
+                pos += (uint32_t)(i - run);
+                ring_copy(pos, "\r\n", 2);
+                pos += 2;
+                run = i + 1;
+            }
+        }
+        ring_copy(pos, data + run, (uint32_t)(len - run));
+    }
+
+    // Publish in reservation order
+    while (__atomic_load_n(&commit_head, __ATOMIC_ACQUIRE) != start) {
+        cpu_relax();
+    }
+    __atomic_store_n(&commit_head, start + (uint32_t)total, __ATOMIC_RELEASE);
+
+    irq_restore(flags);
+
+    console_drain();
+}
+
+// Move ring contents into the UART FIFO
+void console_drain(void) {
+    // Never hold drain_busy across a preemption
+    unsigned long flags = irq_save();
+
+    while (1) {
+        if (__atomic_exchange_n(&drain_busy, 1, __ATOMIC_ACQUIRE)) {
+            // The current drainer re-checks for new output before leaving
+            break;
+        }
+
+        uint32_t pos = tail;
+        uint32_t end = __atomic_load_n(&commit_head, __ATOMIC_ACQUIRE);
+        while (pos != end) {
+            uint32_t index = pos & CONSOLE_MASK;
+            uint32_t chunk = end - pos;
+            if (chunk > CONSOLE_BUFFER_SIZE - index) {
+                chunk = CONSOLE_BUFFER_SIZE - index;
+            }
+            uint32_t written = uart_tx_write(&ring[index], chunk);
+            pos += written;
+            if (written < chunk) {
+                break;
+            }
+        }
+        __atomic_store_n(&tail, pos, __ATOMIC_RELEASE);
+
+        // FIFO full: the TX interrupt picks up from here
+        bool pending = (pos != end);
+        uart_tx_irq_enable(pending);
+
+        __atomic_store_n(&drain_busy, 0, __ATOMIC_RELEASE);
+
+        if (pending || __atomic_load_n(&commit_head, __ATOMIC_ACQUIRE) == pos) {
+            break;
+        }
+    }
+
+    irq_restore(flags);
+}
+
+// Synchronously write out everything in the ring
+void console_flush(void) {
+    unsigned long flags = irq_save();
+
+    for (int spins = 0; spins < CONSOLE_FLUSH_SPINS; spins++) {
+        if (!__atomic_exchange_n(&drain_busy, 1, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        cpu_relax();
+    }
+
+    uint32_t pos = tail;
+    uint32_t end = __atomic_load_n(&commit_head, __ATOMIC_ACQUIRE);
+    while (pos != end) {
+        uint32_t index = pos & CONSOLE_MASK;
+        uint32_t chunk = end - pos;
+        if (chunk > CONSOLE_BUFFER_SIZE - index) {
+            chunk = CONSOLE_BUFFER_SIZE - index;
+        }
+        pos += uart_tx_write(&ring[index], chunk);
+    }
+    __atomic_store_n(&tail, pos, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&drain_busy, 0, __ATOMIC_RELEASE);
+    irq_restore(flags);
+}
+
+// Bytes dropped because the ring was full
+uint32_t console_dropped(void) {
+    return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
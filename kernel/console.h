@@ -0,0 +1,41 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "types.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+// Console ring size in bytes; must be a power of two
+#define CONSOLE_BUFFER_SIZE 16384
+
+// Route uart_puts()/uart_printf() through the console ring. Only turn this
+// on once the UART TX interrupt is available to drain it.
+void console_set_buffered(bool buffered);
+
+// Whether output currently goes through the ring
+bool console_buffered(void);
+
+// Append output to the ring without waiting for the UART. Safe from any
+// core and from IRQ context; if the ring is full the whole write is dropped
+// and counted.
+void console_write(const char* data, size_t len);
+
+// Move ring contents into the UART FIFO; called by writers and by the UART
+// TX interrupt
+void console_drain(void);
+
+// Synchronously write out everything in the ring, e.g. before a panic
+void console_flush(void);
+
+// Bytes dropped because the ring was full
+uint32_t console_dropped(void);
+
+#endif // CONSOLE_H
@@ -0,0 +1,18 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include "types.h"
+
+// CRC-32 (IEEE 802.3, reflected, as used by zlib and Ethernet). Pass 0 to
+// start, and the previous result to continue over more data.
+uint32_t crc32_update(uint32_t crc, const void* data, size_t len);
+
+#endif // CRC32_H
@@ -0,0 +1,160 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "dma_pool.h"
+#include "memory.h"
+#include "irq.h"
+#include "slab.h"
+#include "spinlock.h"
+#include "../drivers/dma.h"
+#include "../drivers/uart.h"
+
+// Free buffers are linked through their first bytes
+typedef struct dma_buf {
+    struct dma_buf* next;
+} dma_buf_t;
+
+// One size class: a contiguous run of equal buffers inside the pool
+typedef struct {
+    size_t size;
+    uint32_t count;
+    uint32_t in_use;
+    uint8_t* base;
+    dma_buf_t* free_list;
+} dma_class_t;
+
+// Buffer sizes and counts; 496 KB in total, reserved as one 512 KB block
+static dma_class_t classes[] = {
+    { CACHE_LINE_SIZE, 256, 0, NULL, NULL },
+    { 256,   128, 0, NULL, NULL },
+    { 1024,  64,  0, NULL, NULL },
+    { 4096,  32,  0, NULL, NULL },
+    { 16384, 16,  0, NULL, NULL },
+};
+
+#define NUM_CLASSES (sizeof(classes) / sizeof(classes[0]))
+
+_Static_assert(DMA_BUF_MAX_SIZE == 16384, "DMA_BUF_MAX_SIZE must match the largest class");
+
+static spinlock_t pool_lock = SPINLOCK_INIT;
+static uint8_t* pool_start;
+static uint8_t* pool_end;
+
+// Reserve the pool
+bool dma_pool_init(void) {
+    if (pool_start != NULL) {
+        return true;
+    }
+
+    size_t total = 0;
+    for (unsigned int i = 0; i < NUM_CLASSES; i++) {
+        total += classes[i].size * classes[i].count;
+    }
+
+    // Page blocks are naturally aligned, so every class base is too
+    uint8_t* pool = (uint8_t*)page_alloc(page_order_for_size(total));
+    if (pool == NULL || !dma_addressable(pool, total)) {
+        page_free(pool);
+        uart_puts("DMA pool: no DMA-visible memory\n");
+        return false;
+    }
+
+    // Largest classes first keeps every base aligned to its size
+    uint8_t* p = pool;
+    for (int i = NUM_CLASSES - 1; i >= 0; i--) {
+        dma_class_t* cls = &classes[i];
+        cls->base = p;
+        cls->free_list = NULL;
+        for (uint32_t n = cls->count; n-- > 0;) {
+            dma_buf_t* buf = (dma_buf_t*)(p + n * cls->size);
+            buf->next = cls->free_list;
+            cls->free_list = buf;
+        }
+        p += cls->size * cls->count;
+    }
+
+    pool_end = p;
+    pool_start = pool;
+    return true;
+}
+
+// Allocate a buffer of at least size bytes
+void* dma_buf_alloc(size_t size) {
+    unsigned int i = 0;
+    while (i < NUM_CLASSES && classes[i].size < size) {
+        i++;
+    }
+    if (i == NUM_CLASSES || pool_start == NULL) {
+        return NULL;
+    }
+
+    unsigned long flags = irq_save();
+    spin_lock(&pool_lock);
+
+    // Fall through to a larger class when this one runs out
+    dma_buf_t* buf = NULL;
+    for (; i < NUM_CLASSES && buf == NULL; i++) {
+        buf = classes[i].free_list;
+        if (buf != NULL) {
+            classes[i].free_list = buf->next;
+            classes[i].in_use++;
+        }
+    }
+
+    spin_unlock(&pool_lock);
+    irq_restore(flags);
+
+    return buf;
+}
+
+// Return a buffer obtained from dma_buf_alloc()
+void dma_buf_free(void* buf) {
+    if (buf == NULL) {
+        return;
+    }
+
+    uint8_t* p = (uint8_t*)buf;
+    dma_class_t* cls = NULL;
+    for (unsigned int i = 0; i < NUM_CLASSES; i++) {
+        uint8_t* base = classes[i].base;
+        if (p >= base && p < base + classes[i].size * classes[i].count) {
+            cls = &classes[i];
+            break;
+        }
+    }
+
+    if (cls == NULL || (size_t)(p - cls->base) % cls->size != 0) {
+        uart_puts("dma_buf_free: not a pool buffer\n");
+        return;
+    }
+
+    unsigned long flags = irq_save();
+    spin_lock(&pool_lock);
+
+    dma_buf_t* node = (dma_buf_t*)p;
+    node->next = cls->free_list;
+    cls->free_list = node;
+    cls->in_use--;
+
+    spin_unlock(&pool_lock);
+    irq_restore(flags);
+}
+
+// Display per-class usage
+void dma_pool_stats(void) {
+    if (pool_start == NULL) {
+        uart_puts("DMA pool: not initialized\n");
+        return;
+    }
+
+    uart_printf("DMA pool: %d KB at 0x%llx\n", (int)((pool_end - pool_start) >> 10),
+                (unsigned long long)(uintptr_t)pool_start);
+    for (unsigned int i = 0; i < NUM_CLASSES; i++) {
+        uart_printf("  %5d bytes: %d/%d buffers\n", (int)classes[i].size,
+                    (int)classes[i].in_use, (int)classes[i].count);
+    }
+}
@@ -0,0 +1,35 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef DMA_POOL_H
+#define DMA_POOL_H
+
+#include "types.h"
+#include <stdbool.h>
+
+// Pinned buffers for device I/O, carved once from DMA-visible RAM into
+// fixed size classes. Every buffer starts on a cache line and owns its
+// last line, so cache maintenance on one buffer never touches another.
+
+// Largest buffer the pool hands out
+#define DMA_BUF_MAX_SIZE    16384
+
+// Reserve the pool; call once after memory_init()
+bool dma_pool_init(void);
+
+// Allocate a buffer of at least size bytes, or NULL if size is above
+// DMA_BUF_MAX_SIZE or its size class is exhausted. Safe from IRQ context.
+void* dma_buf_alloc(size_t size);
+
+// Return a buffer obtained from dma_buf_alloc()
+void dma_buf_free(void* buf);
+
+// Display per-class usage
+void dma_pool_stats(void);
+
+#endif // DMA_POOL_H
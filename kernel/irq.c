@@ -0,0 +1,152 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "irq.h"
+#include "sched.h"
+#include "smp.h"
+#include "timer.h"
+#include "kernel.h"
+#include "../drivers/uart.h"
+#include "../drivers/intc.h"
+
+// Registered handlers, indexed by controller IRQ number
+typedef struct {
+    irq_handler_fn_t handler;
+    void* arg;
+    uint64_t count;
+} irq_action_t;
+
+static irq_action_t irq_actions[NR_IRQS];
+
+#if defined(__aarch64__)
+// Vector table in entry.S
+extern char exception_vectors[];
+#endif
+
+// Scheduler tick on every core
+static void timer_irq(uint32_t irq, void* arg) {
+    (void)irq;
+    (void)arg;
+    timer_tick_rearm();
+    sched_tick();
+}
+
+// Set up the interrupt controller; boot core only, before irq_init_cpu()
+void irq_init(void) {
+    intc_init();
+    irq_actions[IRQ_TIMER].handler = timer_irq;
+}
+
+// Install the exception vectors and start the scheduler tick on the calling core
+void irq_init_cpu(void) {
+#if defined(__aarch64__)
+    asm volatile("msr vbar_el1, %0\n"
+                 "isb" :: "r"(exception_vectors) : "memory");
+#endif
+
+    intc_init_cpu();
+    intc_enable(IRQ_TIMER);
+    timer_tick_start(SCHED_HZ);
+}
+
+// Attach a handler to an interrupt and unmask it
+bool irq_register(uint32_t irq, irq_handler_fn_t handler, void* arg) {
+#if !defined(__aarch64__)
+    // No vector table or controller backend yet; stay polled
+    (void)irq;
+    (void)handler;
+    (void)arg;
+    return false;
+#endif
+    if (irq >= NR_IRQS || handler == NULL || irq_actions[irq].handler != NULL) {
+        return false;
+    }
+
+    irq_actions[irq].arg = arg;
+    __atomic_store_n(&irq_actions[irq].handler, handler, __ATOMIC_RELEASE);
+    intc_enable(irq);
+    return true;
+}
+
+// Mask an interrupt and detach its handler
+void irq_unregister(uint32_t irq) {
+    if (irq >= NR_IRQS) {
+        return;
+    }
+
+    intc_disable(irq);
+    __atomic_store_n(&irq_actions[irq].handler, NULL, __ATOMIC_RELEASE);
+}
+
+// IRQ dispatch, called from entry.S with IRQs masked
+void irq_handler(irq_frame_t* frame) {
+    (void)frame;
+    uint32_t irq;
+
+    while ((irq = intc_next_pending()) != INTC_NONE) {
+        irq_action_t* action = &irq_actions[irq];
+        irq_handler_fn_t handler = __atomic_load_n(&action->handler, __ATOMIC_ACQUIRE);
+
+        if (handler) {
+            action->count++;
+            handler(irq, action->arg);
+        } else {
+            // Nobody will clear the source; mask it rather than storm
+            intc_disable(irq);
+        }
+
+        intc_eoi(irq);
+    }
+}
+
+static const char* exception_names[] = {
+    "Synchronous", "IRQ", "FIQ", "SError"
+};
+
+// Exception classes from ESR_EL1.EC worth naming in a crash report
+static const char* exception_class(uint32_t ec) {
+    switch (ec) {
+        case 0x00: return "unknown reason";
+        case 0x01: return "trapped WFI/WFE";
+        case 0x07: return "FP/SIMD access";
+        case 0x0E: return "illegal execution state";
+        case 0x15: return "SVC";
+        case 0x18: return "trapped MSR/MRS";
+        case 0x20:
+        case 0x21: return "instruction abort";
+        case 0x22: return "PC alignment fault";
+        case 0x24:
+        case 0x25: return "data abort";
+        case 0x26: return "SP alignment fault";
+        case 0x2F: return "SError";
+        case 0x3C: return "BRK";
+        default:   return "other";
+    }
+}
+
+// Synchronous exceptions and SErrors, called from entry.S
+void exception_handler(uint64_t type, irq_frame_t* frame) {
+    uint64_t esr = 0, far = 0;
+#if defined(__aarch64__)
+    asm volatile("mrs %0, esr_el1" : "=r"(esr));
+    asm volatile("mrs %0, far_el1" : "=r"(far));
+#endif
+
+    // Report synchronously; the console may be interrupt driven
+    uart_set_polled();
+
+    uart_printf("\n%s exception on core %d: %s\n",
+                type < 4 ? exception_names[type] : "Unknown", smp_processor_id(),
+                exception_class((uint32_t)(esr >> 26) & 0x3F));
+    uart_printf("  ESR: 0x%016llx  FAR: 0x%016llx\n",
+                (unsigned long long)esr, (unsigned long long)far);
+    uart_printf("  ELR: 0x%016llx  LR:  0x%016llx\n",
+                (unsigned long long)frame->elr, (unsigned long long)frame->regs[30]);
+    uart_printf("  SP:  0x%016llx\n", (unsigned long long)((uint64_t)frame + sizeof(*frame)));
+
+    kernel_panic("Unhandled exception");
+}
@@ -0,0 +1,89 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef IRQ_H
+#define IRQ_H
+
+#include "types.h"
+#include <stdbool.h>
+
+// Register frame saved by the exception entry code in entry.S
+typedef struct {
+    uint64_t regs[31];   // x0-x30
+    uint64_t elr;
+    uint64_t spsr;
+    uint64_t reserved;   // Keeps the frame 16-byte aligned
+} irq_frame_t;
+
+// Mask IRQs on the calling core and return the previous state
+static inline unsigned long irq_save(void) {
+#if defined(__aarch64__)
+    unsigned long flags;
+    asm volatile("mrs %0, daif\n"
+                 "msr daifset, #2" : "=r"(flags) :: "memory");
+    return flags;
+#else
+    return 0;
+#endif
+}
+
+// Restore the IRQ mask saved by irq_save()
+static inline void irq_restore(unsigned long flags) {
+#if defined(__aarch64__)
+    asm volatile("msr daif, %0" :: "r"(flags) : "memory");
+#else
+    (void)flags;
+#endif
+}
+
+static inline void irq_enable(void) {
+#if defined(__aarch64__)
+    asm volatile("msr daifclr, #2" ::: "memory");
+#endif
+}
+
+static inline void irq_disable(void) {
+#if defined(__aarch64__)
+    asm volatile("msr daifset, #2" ::: "memory");
+#endif
+}
+
+// Handler for a device interrupt, called with IRQs masked
+typedef void (*irq_handler_fn_t)(uint32_t irq, void* arg);
+
+// Whether IRQs are masked on the calling core
+static inline bool irq_disabled(void) {
+#if defined(__aarch64__)
+    unsigned long flags;
+    asm volatile("mrs %0, daif" : "=r"(flags));
+    return (flags & (1UL << 7)) != 0;
+#else
+    return true;
+#endif
+}
+
+// Set up the interrupt controller; boot core only, before irq_init_cpu()
+void irq_init(void);
+
+// Install the exception vectors and start the scheduler tick on the calling core
+void irq_init_cpu(void);
+
+// Attach a handler to a controller IRQ number (see drivers/intc.h) and
+// unmask it. Fails if the IRQ is out of range or already claimed.
+bool irq_register(uint32_t irq, irq_handler_fn_t handler, void* arg);
+
+// Mask an interrupt and detach its handler
+void irq_unregister(uint32_t irq);
+
+// IRQ dispatch, called from entry.S with IRQs masked
+void irq_handler(irq_frame_t* frame);
+
+// Synchronous exceptions and SErrors, called from entry.S
+void exception_handler(uint64_t type, irq_frame_t* frame);
+
+#endif // IRQ_H
@@ -8,6 +8,11 @@
 #include "kernel.h"
 #include "../drivers/uart.h"
 #include "memory.h"
+#include "dma_pool.h"
+#include "smp.h"
+#include "sched.h"
+#include "irq.h"
+#include "timer.h"
 #include "shell.h"
 #include "types.h"
 #include "stdio.h"
@@ -29,7 +34,17 @@ void kernel_main() {
     uart_puts("=================================\n\n");
     
     // Initialize subsystems
+    timer_init();
     memory_init();
+    dma_pool_init();
+    sched_init();
+    irq_init();
+    smp_init();
+    irq_init_cpu();
+    irq_enable();
+    if (!uart_irq_init()) {
+        uart_puts("UART: interrupts unavailable, using polled I/O\n");
+    }
     shell_init();
     
     uart_puts("System initialization complete\n\n");
@@ -43,6 +58,9 @@ void kernel_main() {
 
 // Kernel panic function
 void kernel_panic(const char* message) {
+    irq_disable();
+    uart_set_polled();
+    
     uart_puts("\n\n*** KERNEL PANIC ***\n");
     uart_printf("Reason: %s\n", message);
     uart_puts("System halted\n");
@@ -69,20 +69,240 @@
 //
 
 #include "memory.h"
+#include "stdio.h"
+#include "spinlock.h"
 #include "../drivers/uart.h"
 
+// Top of usable physical RAM. On the Raspberry Pi 3 the VideoCore carve-out
+// sits just below the peripheral window; override with -DPHYS_MEMORY_END.
+#ifndef PHYS_MEMORY_END
+#if defined(__aarch64__) || defined(__arm__)
+#define PHYS_MEMORY_END 0x3C000000UL
+#else
+#define PHYS_MEMORY_END 0x08000000UL
+#endif
+#endif
+
+// Per-page state, kept in a byte array indexed by page frame number.
+// Only the first page of a block carries a valid order.
+#define PAGE_STATE_FREE     0x80  // Head of a block on a free list
+#define PAGE_STATE_ALLOC    0x40  // Head of a block owned by a caller
+#define PAGE_STATE_ORDER    0x0F
+
+// Free blocks are linked through their own first bytes
+typedef struct free_block {
+    struct free_block* next;
+    struct free_block* prev;
+} free_block_t;
+
+// Linker symbols marking the kernel image
+extern char __start[];
+extern char __end[];
+
+// Allocator state, protected by page_lock
+static spinlock_t page_lock = SPINLOCK_INIT;
+static uint8_t* page_state;
+static uintptr_t base_pfn;
+static size_t num_pages;
+static free_block_t* free_lists[MAX_ORDER];
+static size_t free_counts[MAX_ORDER];
+static size_t free_pages;
+static size_t reserved_pages;
+
+static inline uintptr_t addr_to_pfn(const void* addr) {
+    return (uintptr_t)addr >> PAGE_SHIFT;
+}
+
+static inline void* pfn_to_addr(uintptr_t pfn) {
+    return (void*)(pfn << PAGE_SHIFT);
+}
+
+static inline uint8_t* state_of(uintptr_t pfn) {
+    return &page_state[pfn - base_pfn];
+}
+
+static inline int pfn_in_range(uintptr_t pfn) {
+    return pfn >= base_pfn && pfn < base_pfn + num_pages;
+}
+
+// Push a block onto the free list of its order
+static void free_list_add(uintptr_t pfn, unsigned int order) {
+    free_block_t* block = (free_block_t*)pfn_to_addr(pfn);
+    block->prev = NULL;
+    block->next = free_lists[order];
+    if (block->next) {
+        block->next->prev = block;
+    }
+    free_lists[order] = block;
+    free_counts[order]++;
+    *state_of(pfn) = PAGE_STATE_FREE | order;
+}
+
+// Unlink a block from anywhere in the free list of its order
+static void free_list_remove(uintptr_t pfn, unsigned int order) {
+    free_block_t* block = (free_block_t*)pfn_to_addr(pfn);
+    if (block->prev) {
+        block->prev->next = block->next;
+    } else {
+        free_lists[order] = block->next;
+    }
+    if (block->next) {
+        block->next->prev = block->prev;
+    }
+    free_counts[order]--;
+    *state_of(pfn) = 0;
+}
+
 // Initialize memory management
 void memory_init() {
-    // Basic memory initialization
-    // For now, this is a placeholder
+    // Managed range starts at the first page after the kernel image
+    uintptr_t start = ((uintptr_t)__end + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    uintptr_t end = PHYS_MEMORY_END & ~(PAGE_SIZE - 1);
+
+    base_pfn = addr_to_pfn((void*)start);
+    num_pages = (end - start) >> PAGE_SHIFT;
+
+    // The page state array lives at the start of the managed range
+    page_state = (uint8_t*)start;
+    memset(page_state, 0, num_pages);
+    reserved_pages = (num_pages + PAGE_SIZE - 1) >> PAGE_SHIFT;
+
+    for (unsigned int order = 0; order < MAX_ORDER; order++) {
+        free_lists[order] = NULL;
+        free_counts[order] = 0;
+    }
+    free_pages = 0;
+
+    // Carve the remaining pages into the largest naturally aligned blocks
+    uintptr_t pfn = base_pfn + reserved_pages;
+    uintptr_t end_pfn = base_pfn + num_pages;
+    while (pfn < end_pfn) {
+        unsigned int order = MAX_ORDER - 1;
+        while ((pfn & ((1UL << order) - 1)) != 0 || pfn + (1UL << order) > end_pfn) {
+            order--;
+        }
+        free_list_add(pfn, order);
+        free_pages += 1UL << order;
+        pfn += 1UL << order;
+    }
+}
+
+// Allocate 2^order contiguous pages
+void* page_alloc(unsigned int order) {
+    if (order >= MAX_ORDER) {
+        return NULL;
+    }
+
+    spin_lock(&page_lock);
+
+    // Find the smallest order with a free block
+    unsigned int current = order;
+    while (current < MAX_ORDER && free_lists[current] == NULL) {
+        current++;
+    }
+    if (current == MAX_ORDER) {
+        spin_unlock(&page_lock);
+        return NULL;
+    }
+
+    uintptr_t pfn = addr_to_pfn(free_lists[current]);
+    free_list_remove(pfn, current);
+
+    // Split down, returning the upper halves to the free lists
+    while (current > order) {
+        current--;
+        free_list_add(pfn + (1UL << current), current);
+    }
+
+    *state_of(pfn) = PAGE_STATE_ALLOC | order;
+    free_pages -= 1UL << order;
+
+    spin_unlock(&page_lock);
+
+    return pfn_to_addr(pfn);
+}
+
+// Return a block to the allocator, merging with free buddies
+void page_free(void* addr) {
+    if (addr == NULL) {
+        return;
+    }
+
+    uintptr_t pfn = addr_to_pfn(addr);
+
+    spin_lock(&page_lock);
+
+    if (!pfn_in_range(pfn) || !(*state_of(pfn) & PAGE_STATE_ALLOC)) {
+        spin_unlock(&page_lock);
+        uart_puts("page_free: invalid or double free\n");
+        return;
+    }
+
+    unsigned int order = *state_of(pfn) & PAGE_STATE_ORDER;
+    *state_of(pfn) = 0;
+    free_pages += 1UL << order;
+
+    // Coalesce while the buddy is a free block of the same order
+    while (order < MAX_ORDER - 1) {
+        uintptr_t buddy = pfn ^ (1UL << order);
+        if (!pfn_in_range(buddy) || *state_of(buddy) != (PAGE_STATE_FREE | order)) {
+            break;
+        }
+        free_list_remove(buddy, order);
+        if (buddy < pfn) {
+            pfn = buddy;
+        }
+        order++;
+    }
+
+    free_list_add(pfn, order);
+
+    spin_unlock(&page_lock);
+}
+
+// Smallest order whose block holds at least size bytes
+unsigned int page_order_for_size(size_t size) {
+    unsigned int order = 0;
+    while (order < MAX_ORDER && (PAGE_SIZE << order) < size) {
+        order++;
+    }
+    return order;
+}
+
+// Fill in a memory statistics snapshot
+void memory_get_info(memory_info_t* info) {
+    if (info == NULL) {
+        return;
+    }
+
+    spin_lock(&page_lock);
+
+    info->kernel_bytes = (size_t)(__end - __start);
+    info->total_bytes = (num_pages << PAGE_SHIFT) + info->kernel_bytes;
+    info->reserved_bytes = reserved_pages << PAGE_SHIFT;
+    info->free_bytes = free_pages << PAGE_SHIFT;
+    info->used_bytes = (num_pages - reserved_pages - free_pages) << PAGE_SHIFT;
+    for (unsigned int order = 0; order < MAX_ORDER; order++) {
+        info->free_blocks[order] = free_counts[order];
+    }
+
+    spin_unlock(&page_lock);
 }
 
 // Display memory statistics
 void memory_stats() {
+    memory_info_t info;
+    memory_get_info(&info);
+
     uart_puts("Memory Statistics:\n");
-    uart_puts("  Total RAM: 1024 MB\n");
-    uart_puts("  Available: 1000 MB\n");
-    uart_puts("  Used: 24 MB\n");
-    uart_puts("  Kernel: 16 MB\n");
-    uart_puts("  User: 8 MB\n");
+    uart_printf("  Total RAM: %d KB\n", (int)(info.total_bytes >> 10));
+    uart_printf("  Available: %d KB\n", (int)(info.free_bytes >> 10));
+    uart_printf("  Used: %d KB\n", (int)(info.used_bytes >> 10));
+    uart_printf("  Kernel: %d KB\n", (int)(info.kernel_bytes >> 10));
+    uart_printf("  Reserved: %d KB\n", (int)(info.reserved_bytes >> 10));
+    uart_puts("  Free blocks per order:");
+    for (unsigned int order = 0; order < MAX_ORDER; order++) {
+        uart_printf(" %d", (int)info.free_blocks[order]);
+    }
+    uart_puts("\n");
 }
\ No newline at end of file
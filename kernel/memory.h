@@ -71,8 +71,40 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
+#include "types.h"
+
+// Page geometry
+#define PAGE_SHIFT      12
+#define PAGE_SIZE       (1UL << PAGE_SHIFT)
+
+// Buddy allocator orders: order n is a block of 2^n contiguous pages.
+// MAX_ORDER - 1 is the largest block handed out (8 MB with 4 KB pages),
+// enough for the zero-copy tensors of the stock segmentation model.
+#define MAX_ORDER       12
+
+// Memory statistics snapshot
+typedef struct {
+    size_t total_bytes;      // Physical RAM managed by the kernel
+    size_t kernel_bytes;     // Kernel image (text, data, bss)
+    size_t reserved_bytes;   // Allocator metadata and alignment padding
+    size_t free_bytes;       // Currently free pages
+    size_t used_bytes;       // Pages handed out by page_alloc()
+    size_t free_blocks[MAX_ORDER]; // Free block count per order
+} memory_info_t;
+
 // Function declarations
 void memory_init();
 void memory_stats();
+void memory_get_info(memory_info_t* info);
+
+// Allocate 2^order physically contiguous, naturally aligned pages.
+// Returns NULL if no block of that order is available.
+void* page_alloc(unsigned int order);
+
+// Return a block obtained from page_alloc()
+void page_free(void* addr);
+
+// Smallest order whose block holds at least size bytes
+unsigned int page_order_for_size(size_t size);
 
 #endif // MEMORY_H
\ No newline at end of file
@@ -0,0 +1,190 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "mmu.h"
+
+#if defined(__aarch64__)
+
+// Memory-Mapped I/O addresses for Raspberry Pi
+#define MMIO_BASE           0x3F000000UL  // For Raspberry Pi 3/4
+// #define MMIO_BASE        0xFE000000UL  // For Raspberry Pi 5
+
+// Block sizes with a 4 KB granule
+#define L1_BLOCK_SIZE       (1UL << 30)   // 1 GB
+#define L2_BLOCK_SIZE       (1UL << 21)   // 2 MB
+#define TABLE_ENTRIES       512
+
+// Descriptor bits
+#define PTE_VALID           (1UL << 0)
+#define PTE_TABLE           (1UL << 1)
+#define PTE_BLOCK           (0UL << 1)
+#define PTE_ATTR_INDEX(n)   ((uint64_t)(n) << 2)
+#define PTE_SH_INNER        (3UL << 8)
+#define PTE_AF              (1UL << 10)
+#define PTE_PXN             (1UL << 53)
+#define PTE_UXN             (1UL << 54)
+
+// MAIR_EL1 attribute slots
+#define MT_DEVICE_nGnRE     0
+#define MT_NORMAL           1
+#define MT_NORMAL_NC        2
+#define MAIR_VALUE          ((0x04UL << (8 * MT_DEVICE_nGnRE)) |  \
+                             (0xFFUL << (8 * MT_NORMAL)) |        \
+                             (0x44UL << (8 * MT_NORMAL_NC)))
+
+// Block descriptors for each memory type
+#define BLOCK_NORMAL        (PTE_VALID | PTE_BLOCK | PTE_ATTR_INDEX(MT_NORMAL) | PTE_SH_INNER | PTE_AF)
+#define BLOCK_DEVICE        (PTE_VALID | PTE_BLOCK | PTE_ATTR_INDEX(MT_DEVICE_nGnRE) | PTE_AF | PTE_PXN | PTE_UXN)
+
+// TCR_EL1: 32-bit VA/PA, 4 KB granule, write-back inner shareable walks,
+// TTBR1 walks disabled
+#define TCR_T0SZ            (64 - 32)
+#define TCR_IRGN0_WBWA      (1UL << 8)
+#define TCR_ORGN0_WBWA      (1UL << 10)
+#define TCR_SH0_INNER       (3UL << 12)
+#define TCR_TG0_4K          (0UL << 14)
+#define TCR_EPD1            (1UL << 23)
+#define TCR_TG1_4K          (2UL << 30)
+#define TCR_VALUE           (TCR_T0SZ | TCR_IRGN0_WBWA | TCR_ORGN0_WBWA | TCR_SH0_INNER | \
+                             TCR_TG0_4K | TCR_EPD1 | TCR_TG1_4K)
+
+// SCTLR_EL1 bits
+#define SCTLR_M             (1UL << 0)
+#define SCTLR_C             (1UL << 2)
+#define SCTLR_I             (1UL << 12)
+
+// Translation tables: one level 1 table covering 4 GB and one level 2 table
+// splitting the first gigabyte into 2 MB blocks
+static uint64_t l1_table[TABLE_ENTRIES] __attribute__((aligned(4096)));
+static uint64_t l2_table[TABLE_ENTRIES] __attribute__((aligned(4096)));
+
+// Build the identity map and switch it on
+void mmu_init(void) {
+    // First gigabyte: RAM up to the peripheral window, then devices
+    for (uint64_t i = 0; i < TABLE_ENTRIES; i++) {
+        uint64_t addr = i * L2_BLOCK_SIZE;
+        l2_table[i] = addr | (addr < MMIO_BASE ? BLOCK_NORMAL : BLOCK_DEVICE);
+    }
+
+    l1_table[0] = (uint64_t)l2_table | PTE_VALID | PTE_TABLE;
+    // BCM2836 ARM local peripherals (core timers, mailboxes, interrupts)
+    l1_table[1] = (1 * L1_BLOCK_SIZE) | BLOCK_DEVICE;
+    // Raspberry Pi 4/5 peripheral window at 0xFE000000
+    l1_table[3] = (3 * L1_BLOCK_SIZE) | BLOCK_DEVICE;
+
+    mmu_enable();
+}
+
+// Program the translation registers and enable the MMU and caches
+void mmu_enable(void) {
+    uint64_t sctlr;
+
+    asm volatile("msr mair_el1, %0" :: "r"(MAIR_VALUE));
+    asm volatile("msr tcr_el1, %0" :: "r"(TCR_VALUE));
+    asm volatile("msr ttbr0_el1, %0" :: "r"((uint64_t)l1_table));
+    asm volatile("isb");
+
+    // Discard any stale translations and instructions
+    asm volatile("dsb ish\n"
+                 "tlbi vmalle1\n"
+                 "ic iallu\n"
+                 "dsb ish\n"
+                 "isb" ::: "memory");
+
+    asm volatile("mrs %0, sctlr_el1" : "=r"(sctlr));
+    sctlr |= SCTLR_M | SCTLR_C | SCTLR_I;
+    asm volatile("msr sctlr_el1, %0\n"
+                 "isb" :: "r"(sctlr) : "memory");
+}
+
+// Turn the data cache off, write it back and invalidate it by set/way up to
+// the point of coherency, then turn the MMU and instruction cache off. Once
+// the data cache is off, dirty lines would hide the stack from this core, so
+// the whole sequence runs in registers only.
+void mmu_disable(void) {
+    asm volatile("mrs   x0, sctlr_el1\n"
+                 "bic   x0, x0, %0\n"
+                 "msr   sctlr_el1, x0\n"
+                 "isb\n"
+                 "dmb   sy\n"
+                 "mrs   x0, clidr_el1\n"
+                 "and   x3, x0, #0x7000000\n"
+                 "lsr   x3, x3, #23\n"            // level of coherency * 2
+                 "cbz   x3, 5f\n"
+                 "mov   x10, #0\n"                // cache level * 2
+                 "1:\n"
+                 "add   x2, x10, x10, lsr #1\n"
+                 "lsr   x1, x0, x2\n"
+                 "and   x1, x1, #7\n"             // cache type at this level
+                 "cmp   x1, #2\n"
+                 "b.lt  4f\n"                     // no data cache
+                 "msr   csselr_el1, x10\n"
+                 "isb\n"
+                 "mrs   x1, ccsidr_el1\n"
+                 "and   x2, x1, #7\n"
+                 "add   x2, x2, #4\n"             // log2 of the line size
+                 "mov   x4, #0x3ff\n"
+                 "and   x4, x4, x1, lsr #3\n"     // highest way
+                 "clz   w5, w4\n"                 // way field shift
+                 "mov   x7, #0x7fff\n"
+                 "and   x7, x7, x1, lsr #13\n"    // highest set
+                 "2:\n"
+                 "mov   x9, x4\n"
+                 "3:\n"
+                 "lsl   x6, x9, x5\n"
+                 "orr   x11, x10, x6\n"
+                 "lsl   x6, x7, x2\n"
+                 "orr   x11, x11, x6\n"
+                 "dc    cisw, x11\n"
+                 "subs  x9, x9, #1\n"
+                 "b.ge  3b\n"
+                 "subs  x7, x7, #1\n"
+                 "b.ge  2b\n"
+                 "4:\n"
+                 "add   x10, x10, #2\n"
+                 "cmp   x3, x10\n"
+                 "b.gt  1b\n"
+                 "5:\n"
+                 "msr   csselr_el1, xzr\n"
+                 "dsb   sy\n"
+                 "isb\n"
+                 "mrs   x0, sctlr_el1\n"
+                 "bic   x0, x0, %1\n"
+                 "msr   sctlr_el1, x0\n"
+                 "isb\n"
+                 "ic    iallu\n"
+                 "dsb   sy\n"
+                 "isb"
+                 :: "r"(SCTLR_C), "r"(SCTLR_M | SCTLR_I)
+                 : "x0", "x1", "x2", "x3", "x4", "x5", "x6", "x7", "x9", "x10", "x11",
+                   "cc", "memory");
+}
+
+// Whether the MMU and data cache are on
+bool mmu_enabled(void) {
+    uint64_t sctlr;
+    asm volatile("mrs %0, sctlr_el1" : "=r"(sctlr));
+    return (sctlr & (SCTLR_M | SCTLR_C)) == (SCTLR_M | SCTLR_C);
+}
+
+#else
+
+// Other architectures run with the firmware's memory setup for now
+void mmu_init(void) {
+}
+
+void mmu_enable(void) {
+}
+
+void mmu_disable(void) {
+}
+
+bool mmu_enabled(void) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,31 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef MMU_H
+#define MMU_H
+
+#include "types.h"
+#include <stdbool.h>
+
+// Build the identity-mapped page tables and enable the MMU and caches on the
+// boot core. Called from boot.S before kernel_main.
+void mmu_init(void);
+
+// Enable the MMU and caches on the calling core using the tables built by
+// mmu_init()
+void mmu_enable(void);
+
+// Write back the data cache and turn the MMU and caches off on the calling
+// core; mmu_enable() turns them back on. Keep interrupts masked in between
+// and take no locks: exclusive accesses need the caches on.
+void mmu_disable(void);
+
+// Whether the MMU and data cache are on for the calling core
+bool mmu_enabled(void);
+
+#endif // MMU_H
@@ -0,0 +1,85 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "mutex.h"
+#include "irq.h"
+
+// Take the mutex if it is free; never sleeps
+bool mutex_trylock(mutex_t* mutex) {
+    thread_t* self = thread_current();
+    unsigned long flags = irq_save();
+    spin_lock(&mutex->lock);
+    bool taken = !mutex->locked;
+    if (taken) {
+        mutex->locked = 1;
+        mutex->owner = self;
+    }
+    spin_unlock(&mutex->lock);
+    irq_restore(flags);
+    return taken;
+}
+
+// Take the mutex, sleeping until it is free
+void mutex_lock(mutex_t* mutex) {
+    thread_t* self = thread_current();
+
+    // Nothing to sleep in; wait for the holder to let go
+    if (self == NULL || irq_disabled()) {
+        while (!mutex_trylock(mutex)) {
+            cpu_relax();
+        }
+        return;
+    }
+
+    unsigned long flags = irq_save();
+    spin_lock(&mutex->lock);
+    if (!mutex->locked) {
+        mutex->locked = 1;
+        mutex->owner = self;
+        spin_unlock(&mutex->lock);
+        irq_restore(flags);
+        return;
+    }
+    self->wait_next = NULL;
+    if (mutex->waiters_tail != NULL) {
+        mutex->waiters_tail->wait_next = self;
+    } else {
+        mutex->waiters = self;
+    }
+    mutex->waiters_tail = self;
+    spin_unlock(&mutex->lock);
+    irq_restore(flags);
+
+    // mutex_unlock() makes us the owner before waking us
+    while (__atomic_load_n(&mutex->owner, __ATOMIC_ACQUIRE) != self) {
+        thread_block();
+    }
+}
+
+// Release the mutex, waking the next waiter
+void mutex_unlock(mutex_t* mutex) {
+    unsigned long flags = irq_save();
+    spin_lock(&mutex->lock);
+    thread_t* next = mutex->waiters;
+    if (next != NULL) {
+        mutex->waiters = next->wait_next;
+        if (mutex->waiters == NULL) {
+            mutex->waiters_tail = NULL;
+        }
+        // Hand over without unlocking so nobody can slip in between
+        __atomic_store_n(&mutex->owner, next, __ATOMIC_RELEASE);
+    } else {
+        mutex->owner = NULL;
+        mutex->locked = 0;
+    }
+    spin_unlock(&mutex->lock);
+    irq_restore(flags);
+
+    if (next != NULL) {
+        thread_wake(next);
+    }
+}
@@ -0,0 +1,48 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef MUTEX_H
+#define MUTEX_H
+
+#include "types.h"
+#include "spinlock.h"
+#include "sched.h"
+#include <stdbool.h>
+
+// Sleeping lock for long critical sections such as a bus transfer. Waiters
+// sleep in FIFO order and unlock hands the mutex straight to the first one.
+// Callers that cannot sleep (IRQs masked, or no scheduler yet) spin instead.
+// Never take a mutex from IRQ context.
+typedef struct {
+    spinlock_t lock;            // Protects the fields below
+    uint32_t locked;
+    thread_t* owner;            // NULL when held outside a thread
+    thread_t* waiters;          // Sleeping waiters, linked through wait_next
+    thread_t* waiters_tail;
+} mutex_t;
+
+#define MUTEX_INIT { SPINLOCK_INIT, 0, NULL, NULL, NULL }
+
+static inline void mutex_init(mutex_t* mutex) {
+    spin_lock_init(&mutex->lock);
+    mutex->locked = 0;
+    mutex->owner = NULL;
+    mutex->waiters = NULL;
+    mutex->waiters_tail = NULL;
+}
+
+// Take the mutex, sleeping until it is free
+void mutex_lock(mutex_t* mutex);
+
+// Take the mutex if it is free; never sleeps
+bool mutex_trylock(mutex_t* mutex);
+
+// Release the mutex, waking the next waiter
+void mutex_unlock(mutex_t* mutex);
+
+#endif // MUTEX_H
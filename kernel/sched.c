@@ -0,0 +1,671 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "sched.h"
+#include "irq.h"
+#include "smp.h"
+#include "slab.h"
+#include "memory.h"
+#include "kernel.h"
+#include "stdio.h"
+#include "timer.h"
+#include "../drivers/uart.h"
+
+// Kernel thread stacks: 16 KB
+#define THREAD_STACK_ORDER  2
+#define THREAD_STACK_SIZE   (PAGE_SIZE << THREAD_STACK_ORDER)
+
+// Per-core run queue. Each core pops from the head of its own queue; idle
+// cores steal from the tail of the busiest one.
+typedef struct {
+    spinlock_t lock;
+    thread_t* head;
+    thread_t* tail;
+    uint32_t nr_running;        // Threads queued, excluding current
+    thread_t* current;
+    thread_t* idle;
+    volatile uint32_t need_resched;
+    uint64_t ticks;
+    uint64_t switches;
+    uint64_t steals;
+} run_queue_t;
+
+static run_queue_t run_queues[NR_CPUS];
+static kmem_cache_t* thread_cache = NULL;
+static volatile bool sched_ready = false;
+
+// All live threads, for sched_stats()
+static thread_t* thread_list = NULL;
+static spinlock_t thread_list_lock = SPINLOCK_INIT;
+static uint32_t next_tid = 0;
+
+// Exited threads waiting to be freed, linked through rq_next. They cannot
+// be freed inside schedule_tail() because the allocator locks are not
+// IRQ-safe.
+static thread_t* zombie_list = NULL;
+
+// Threads in thread_sleep_ns() or thread_block_timeout(), ordered by wake_at. Lock order is
+// sleep_lock before a thread's lock and the run queue locks.
+static thread_t* sleep_list = NULL;
+static spinlock_t sleep_lock = SPINLOCK_INIT;
+
+// Context switch and new-thread entry in entry.S
+extern thread_t* cpu_switch_to(thread_t* prev, thread_t* next);
+extern char thread_trampoline[];
+
+static const char* state_names[] = {"ready", "running", "blocked", "dead"};
+
+// Sleep until another core queues work or an interrupt arrives
+static inline void cpu_idle_wait(void) {
+#if defined(__aarch64__) || defined(__arm__)
+    asm volatile("wfe" ::: "memory");
+#else
+    cpu_relax();
+#endif
+}
+
+// Wake cores sleeping in cpu_idle_wait()
+static inline void cpu_kick(void) {
+#if defined(__aarch64__) || defined(__arm__)
+    asm volatile("dsb ish\n"
+                 "sev" ::: "memory");
+#endif
+}
+
+static run_queue_t* this_rq(void) {
+    return &run_queues[smp_processor_id()];
+}
+
+// Whether a thread's registers are still live on some core
+static inline bool thread_on_cpu(thread_t* thread) {
+    return __atomic_load_n(&thread->on_cpu, __ATOMIC_ACQUIRE) != 0;
+}
+
+// Append a thread to a run queue; caller holds rq->lock
+static void rq_enqueue(run_queue_t* rq, thread_t* thread) {
+    thread->rq_next = NULL;
+    thread->rq_prev = rq->tail;
+    if (rq->tail) {
+        rq->tail->rq_next = thread;
+    } else {
+        rq->head = thread;
+    }
+    rq->tail = thread;
+    rq->nr_running++;
+}
+
+// Unlink a thread from a run queue; caller holds rq->lock
+static void rq_remove(run_queue_t* rq, thread_t* thread) {
+    if (thread->rq_prev) {
+        thread->rq_prev->rq_next = thread->rq_next;
+    } else {
+        rq->head = thread->rq_next;
+    }
+    if (thread->rq_next) {
+        thread->rq_next->rq_prev = thread->rq_prev;
+    } else {
+        rq->tail = thread->rq_prev;
+    }
+    thread->rq_next = thread->rq_prev = NULL;
+    rq->nr_running--;
+}
+
+// Take the oldest runnable thread. A thread whose context is still live on
+// another core (on_cpu) cannot be resumed yet; self is the caller's own
+// thread, which may be picked straight back up.
+static thread_t* rq_pop(run_queue_t* rq, thread_t* self) {
+    for (thread_t* thread = rq->head; thread; thread = thread->rq_next) {
+        if (thread == self || !thread_on_cpu(thread)) {
+            rq_remove(rq, thread);
+            return thread;
+        }
+    }
+    return NULL;
+}
+
+// Steal the most recently queued migratable thread from the busiest
+// other core
+static thread_t* steal_work(unsigned int cpu) {
+    run_queue_t* victim = NULL;
+    uint32_t most = 0;
+    for (unsigned int other = 0; other < NR_CPUS; other++) {
+        if (other != cpu && run_queues[other].nr_running > most) {
+            most = run_queues[other].nr_running;
+            victim = &run_queues[other];
+        }
+    }
+    if (victim == NULL) {
+        return NULL;
+    }
+
+    // Never spin on a remote lock from inside schedule()
+    if (!spin_trylock(&victim->lock)) {
+        return NULL;
+    }
+    thread_t* thread = victim->tail;
+    while (thread && (thread_on_cpu(thread) || thread->pinned_cpu != SCHED_ANY_CPU)) {
+        thread = thread->rq_prev;
+    }
+    if (thread) {
+        rq_remove(victim, thread);
+    }
+    spin_unlock(&victim->lock);
+
+    return thread;
+}
+
+// Pick the next thread and switch to it
+void schedule(void) {
+    unsigned long flags = irq_save();
+    unsigned int cpu = smp_processor_id();
+    run_queue_t* rq = &run_queues[cpu];
+    thread_t* prev = rq->current;
+
+    rq->need_resched = 0;
+
+    spin_lock(&rq->lock);
+    if (prev->state == THREAD_RUNNING && prev != rq->idle) {
+        prev->state = THREAD_READY;
+        rq_enqueue(rq, prev);
+    }
+    thread_t* next = rq_pop(rq, prev);
+    spin_unlock(&rq->lock);
+
+    if (next == NULL) {
+        next = steal_work(cpu);
+        if (next) {
+            rq->steals++;
+        }
+    }
+    if (next == NULL) {
+        next = rq->idle;
+    }
+
+    next->state = THREAD_RUNNING;
+    next->cpu = cpu;
+    next->slice = SCHED_TIME_SLICE;
+
+    if (next != prev) {
+        next->on_cpu = 1;
+        rq->current = next;
+        rq->switches++;
+
+        // Returns on next's stack, possibly much later and on another core
+        prev = cpu_switch_to(prev, next);
+        schedule_tail(prev);
+    }
+
+    irq_restore(flags);
+}
+
+// Finish a context switch on the new thread: prev's registers are saved,
+// so other cores may now run it, and a dead prev can be reclaimed
+void schedule_tail(thread_t* prev) {
+    if (prev->state == THREAD_DEAD) {
+        thread_t* head = __atomic_load_n(&zombie_list, __ATOMIC_RELAXED);
+        do {
+            prev->rq_next = head;
+        } while (!__atomic_compare_exchange_n(&zombie_list, &head, prev, true,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+        return;
+    }
+
+    __atomic_store_n(&prev->on_cpu, 0, __ATOMIC_RELEASE);
+    cpu_kick();
+}
+
+// Free the stacks and descriptors of exited threads
+static void reap_zombies(void) {
+    thread_t* zombie = __atomic_exchange_n(&zombie_list, NULL, __ATOMIC_ACQUIRE);
+
+    while (zombie) {
+        thread_t* next = zombie->rq_next;
+
+        unsigned long flags = irq_save();
+        spin_lock(&thread_list_lock);
+        thread_t** link = &thread_list;
+        while (*link && *link != zombie) {
+            link = &(*link)->all_next;
+        }
+        if (*link) {
+            *link = zombie->all_next;
+        }
+        spin_unlock(&thread_list_lock);
+        irq_restore(flags);
+
+        page_free(zombie->stack);
+        kmem_cache_free(thread_cache, zombie);
+        zombie = next;
+    }
+}
+
+// Allocate a thread and its stack; the caller sets the initial context
+static thread_t* thread_alloc(const char* name, bool with_stack) {
+    thread_t* thread = kmem_cache_alloc(thread_cache);
+    if (thread == NULL) {
+        return NULL;
+    }
+    memset(thread, 0, sizeof(*thread));
+
+    if (with_stack) {
+        thread->stack = page_alloc(THREAD_STACK_ORDER);
+        if (thread->stack == NULL) {
+            kmem_cache_free(thread_cache, thread);
+            return NULL;
+        }
+    }
+
+    strncpy(thread->name, name, sizeof(thread->name) - 1);
+    thread->pinned_cpu = SCHED_ANY_CPU;
+    thread->slice = SCHED_TIME_SLICE;
+    spin_lock_init(&thread->lock);
+
+    unsigned long flags = irq_save();
+    spin_lock(&thread_list_lock);
+    thread->tid = next_tid++;
+    thread->all_next = thread_list;
+    thread_list = thread;
+    spin_unlock(&thread_list_lock);
+    irq_restore(flags);
+
+    return thread;
+}
+
+// Arrange for the first switch to a thread to enter thread_trampoline,
+// which calls fn(arg) on the thread's own stack
+static void thread_init_context(thread_t* thread, thread_fn_t fn, void* arg) {
+    uint64_t top = (uint64_t)thread->stack + THREAD_STACK_SIZE;
+    uint64_t* regs = thread->context.regs;
+
+#if defined(__aarch64__)
+    // x19-x28, x29, x30, sp
+    regs[0] = (uint64_t)fn;
+    regs[1] = (uint64_t)arg;
+    regs[11] = (uint64_t)thread_trampoline;
+    regs[12] = top;
+#elif defined(__x86_64__)
+    // rbx, rbp, r12-r15, rsp; the trampoline is reached by ret
+    top -= 8;
+    *(uint64_t*)top = (uint64_t)thread_trampoline;
+    regs[0] = (uint64_t)fn;
+    regs[2] = (uint64_t)arg;
+    regs[6] = top;
+#elif defined(__riscv)
+    // ra, sp, s0-s11
+    regs[0] = (uint64_t)thread_trampoline;
+    regs[1] = top;
+    regs[2] = (uint64_t)fn;
+    regs[3] = (uint64_t)arg;
+#endif
+}
+
+// Run an idle thread: look for work, otherwise sleep until an event
+static void idle_loop(void) {
+    run_queue_t* rq = this_rq();
+    while (1) {
+        reap_zombies();
+        schedule();
+        if (rq->nr_running == 0) {
+            cpu_idle_wait();
+        }
+    }
+}
+
+static void idle_thread(void* arg) {
+    (void)arg;
+    idle_loop();
+}
+
+// Set up run queues and adopt the boot context as the "main" thread
+void sched_init(void) {
+    thread_cache = kmem_cache_create("thread", sizeof(thread_t), 0, NULL);
+    if (thread_cache == NULL) {
+        kernel_panic("sched: cannot create thread cache");
+    }
+
+    for (unsigned int cpu = 0; cpu < NR_CPUS; cpu++) {
+        spin_lock_init(&run_queues[cpu].lock);
+    }
+
+    run_queue_t* rq = &run_queues[0];
+
+    thread_t* main = thread_alloc("main", false);
+    thread_t* idle = thread_alloc("idle0", true);
+    if (main == NULL || idle == NULL) {
+        kernel_panic("sched: cannot allocate boot threads");
+    }
+    thread_init_context(idle, idle_thread, NULL);
+    idle->pinned_cpu = 0;
+
+    main->state = THREAD_RUNNING;
+    main->on_cpu = 1;
+    rq->current = main;
+    rq->idle = idle;
+
+    __atomic_store_n(&sched_ready, true, __ATOMIC_RELEASE);
+}
+
+// Adopt a secondary core's boot context as its idle thread and start
+// scheduling on it
+void sched_start_cpu(void) {
+    unsigned int cpu = smp_processor_id();
+    run_queue_t* rq = &run_queues[cpu];
+
+    char name[16] = "idle";
+    name[4] = '0' + cpu;
+    name[5] = '\0';
+
+    thread_t* idle = thread_alloc(name, false);
+    if (idle == NULL) {
+        kernel_panic("sched: cannot allocate idle thread");
+    }
+    idle->pinned_cpu = cpu;
+    idle->cpu = cpu;
+    idle->state = THREAD_RUNNING;
+    idle->on_cpu = 1;
+    rq->idle = idle;
+    rq->current = idle;
+
+    irq_init_cpu();
+    irq_enable();
+    idle_loop();
+    __builtin_unreachable();
+}
+
+// Least loaded online core
+static unsigned int pick_cpu(void) {
+    unsigned int best = 0;
+    for (unsigned int cpu = 1; cpu < NR_CPUS; cpu++) {
+        if (smp_cpu_online(cpu) && run_queues[cpu].idle &&
+            run_queues[cpu].nr_running < run_queues[best].nr_running) {
+            best = cpu;
+        }
+    }
+    return best;
+}
+
+// Queue a ready thread on its core and wake idle cores
+static void thread_enqueue(thread_t* thread) {
+    run_queue_t* rq = &run_queues[thread->cpu];
+    unsigned long flags = irq_save();
+    spin_lock(&rq->lock);
+    rq_enqueue(rq, thread);
+    spin_unlock(&rq->lock);
+    irq_restore(flags);
+    cpu_kick();
+}
+
+// Create a runnable kernel thread on the given core or SCHED_ANY_CPU
+thread_t* thread_create_on(const char* name, thread_fn_t fn, void* arg, int cpu) {
+    if (!sched_ready || fn == NULL) {
+        return NULL;
+    }
+    if (cpu != SCHED_ANY_CPU && !smp_cpu_online(cpu)) {
+        return NULL;
+    }
+
+    reap_zombies();
+
+    thread_t* thread = thread_alloc(name, true);
+    if (thread == NULL) {
+        return NULL;
+    }
+    thread_init_context(thread, fn, arg);
+
+    thread->pinned_cpu = cpu;
+    thread->cpu = (cpu == SCHED_ANY_CPU) ? pick_cpu() : (unsigned int)cpu;
+    thread->state = THREAD_READY;
+    thread_enqueue(thread);
+
+    return thread;
+}
+
+// Create a runnable kernel thread on the least loaded core
+thread_t* thread_create(const char* name, thread_fn_t fn, void* arg) {
+    return thread_create_on(name, fn, arg, SCHED_ANY_CPU);
+}
+
+// Terminate the calling thread; its stack is freed by the next thread to run
+void thread_exit(void) {
+    irq_disable();
+    thread_current()->state = THREAD_DEAD;
+    schedule();
+    kernel_panic("sched: dead thread rescheduled");
+    __builtin_unreachable();
+}
+
+// Thread running on the calling core
+thread_t* thread_current(void) {
+    unsigned long flags = irq_save();
+    thread_t* thread = this_rq()->current;
+    irq_restore(flags);
+    return thread;
+}
+
+// Sleep until thread_wake(); returns at once if a wake-up is already pending
+void thread_block(void) {
+    unsigned long flags = irq_save();
+    thread_t* self = this_rq()->current;
+
+    spin_lock(&self->lock);
+    if (self->wake_pending) {
+        self->wake_pending = 0;
+        spin_unlock(&self->lock);
+        irq_restore(flags);
+        return;
+    }
+    self->state = THREAD_BLOCKED;
+    spin_unlock(&self->lock);
+
+    schedule();
+    irq_restore(flags);
+}
+
+// Make a blocked thread runnable. Safe to call from IRQ context.
+void thread_wake(thread_t* thread) {
+    unsigned long flags = irq_save();
+
+    spin_lock(&thread->lock);
+    if (thread->state != THREAD_BLOCKED) {
+        thread->wake_pending = 1;
+        spin_unlock(&thread->lock);
+        irq_restore(flags);
+        return;
+    }
+    thread->state = THREAD_READY;
+    spin_unlock(&thread->lock);
+
+    thread_enqueue(thread);
+    irq_restore(flags);
+}
+
+// Queue the calling thread on the sleep list until deadline
+static void sleep_enqueue(thread_t* self, uint64_t deadline) {
+    unsigned long flags = irq_save();
+    spin_lock(&sleep_lock);
+    self->wake_at = deadline;
+    thread_t** link = &sleep_list;
+    while (*link != NULL && (*link)->wake_at <= deadline) {
+        link = &(*link)->sleep_next;
+    }
+    self->sleep_next = *link;
+    *link = self;
+    spin_unlock(&sleep_lock);
+    irq_restore(flags);
+}
+
+// Take the calling thread off the sleep list if the tick has not already
+static void sleep_dequeue(thread_t* self) {
+    unsigned long flags = irq_save();
+    spin_lock(&sleep_lock);
+    for (thread_t** link = &sleep_list; *link != NULL; link = &(*link)->sleep_next) {
+        if (*link == self) {
+            *link = self->sleep_next;
+            break;
+        }
+    }
+    spin_unlock(&sleep_lock);
+    irq_restore(flags);
+}
+
+// Sleep for at least ns nanoseconds
+void thread_sleep_ns(uint64_t ns) {
+    uint64_t deadline = ktime_get_ns() + ns;
+    thread_t* self = thread_current();
+
+    // Nothing will tick to wake us; give the CPU away until it is time
+    if (self == NULL || irq_disabled()) {
+        while (ktime_get_ns() < deadline) {
+            if (self != NULL) {
+                sched_yield();
+            }
+        }
+        return;
+    }
+
+    sleep_enqueue(self, deadline);
+
+    // Other wake-ups may arrive first; only the deadline ends the sleep
+    while (ktime_get_ns() < deadline) {
+        thread_block();
+    }
+
+    // Still queued if something else woke us right at the deadline
+    sleep_dequeue(self);
+}
+
+// Sleep until thread_wake() or until ns nanoseconds pass
+bool thread_block_timeout(uint64_t ns) {
+    uint64_t deadline = ktime_get_ns() + ns;
+    thread_t* self = thread_current();
+
+    // Nothing will tick to end the wait; give the CPU away once instead
+    if (self == NULL || irq_disabled()) {
+        if (self != NULL) {
+            sched_yield();
+        }
+        return ktime_get_ns() < deadline;
+    }
+
+    sleep_enqueue(self, deadline);
+    thread_block();
+    sleep_dequeue(self);
+
+    return ktime_get_ns() < deadline;
+}
+
+// Wake sleepers whose deadline has passed; called from the tick
+static void wake_sleepers(void) {
+    if (__atomic_load_n(&sleep_list, __ATOMIC_RELAXED) == NULL) {
+        return;
+    }
+
+    // Whichever core gets the lock does the work for this tick
+    if (!spin_trylock(&sleep_lock)) {
+        return;
+    }
+
+    uint64_t now = ktime_get_ns();
+    while (sleep_list != NULL && sleep_list->wake_at <= now) {
+        thread_t* thread = sleep_list;
+        sleep_list = thread->sleep_next;
+        thread_wake(thread);
+    }
+
+    spin_unlock(&sleep_lock);
+}
+
+// Give up the CPU to the next runnable thread
+void sched_yield(void) {
+    schedule();
+}
+
+// Timer tick, called from the IRQ handler on every core
+void sched_tick(void) {
+    if (!sched_ready) {
+        return;
+    }
+
+    run_queue_t* rq = this_rq();
+    thread_t* current = rq->current;
+    rq->ticks++;
+
+    wake_sleepers();
+
+    if (current == NULL || current == rq->idle) {
+        return;
+    }
+
+    current->run_ticks++;
+    if (current->slice > 0) {
+        current->slice--;
+    }
+    if (current->slice == 0) {
+        rq->need_resched = 1;
+    }
+}
+
+// Preempt on IRQ return if the tick asked for it; called from entry.S
+void sched_preempt_irq(void) {
+    if (!sched_ready) {
+        return;
+    }
+
+    run_queue_t* rq = this_rq();
+    if (rq->need_resched && rq->current && rq->current->preempt_count == 0) {
+        schedule();
+    }
+}
+
+// Preemption control is a no-op until the calling core has a current thread
+void preempt_disable(void) {
+    unsigned long flags = irq_save();
+    thread_t* current = this_rq()->current;
+    if (current) {
+        current->preempt_count++;
+    }
+    irq_restore(flags);
+}
+
+void preempt_enable(void) {
+    unsigned long flags = irq_save();
+    run_queue_t* rq = this_rq();
+    bool resched = false;
+    if (rq->current) {
+        resched = --rq->current->preempt_count == 0 && rq->need_resched;
+    }
+    irq_restore(flags);
+
+    if (resched) {
+        schedule();
+    }
+}
+
+// Display run queue and thread statistics
+void sched_stats(void) {
+    uart_puts("Scheduler:\n");
+    for (unsigned int cpu = 0; cpu < NR_CPUS; cpu++) {
+        run_queue_t* rq = &run_queues[cpu];
+        if (rq->idle == NULL) {
+            continue;
+        }
+        uart_printf("  core %u: %u queued, %llu ticks, %llu switches, %llu steals\n",
+                    cpu, rq->nr_running, (unsigned long long)rq->ticks,
+                    (unsigned long long)rq->switches, (unsigned long long)rq->steals);
+    }
+
+    uart_puts("  TID   CPU  STATE    TICKS      NAME\n");
+    unsigned long flags = irq_save();
+    spin_lock(&thread_list_lock);
+    for (thread_t* thread = thread_list; thread; thread = thread->all_next) {
+        uart_printf("  %-5u %-4u %-8s %-10llu %s\n",
+                    thread->tid, thread->cpu, state_names[thread->state],
+                    (unsigned long long)thread->run_ticks, thread->name);
+    }
+    spin_unlock(&thread_list_lock);
+    irq_restore(flags);
+}
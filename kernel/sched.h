@@ -0,0 +1,118 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "types.h"
+#include "spinlock.h"
+#include <stdbool.h>
+
+// Scheduler tick rate and time slice
+#define SCHED_HZ            100
+#define SCHED_TIME_SLICE    2       // Ticks a thread runs before preemption
+
+// Pass as the CPU to let the scheduler place a thread anywhere
+#define SCHED_ANY_CPU       (-1)
+
+// Thread states
+typedef enum {
+    THREAD_READY = 0,
+    THREAD_RUNNING = 1,
+    THREAD_BLOCKED = 2,
+    THREAD_DEAD = 3
+} thread_state_t;
+
+// Callee-saved registers preserved across cpu_switch_to(); the layout is
+// architecture specific and owned by entry.S
+typedef struct {
+    uint64_t regs[14];
+} cpu_context_t;
+
+typedef void (*thread_fn_t)(void* arg);
+
+typedef struct thread {
+    cpu_context_t context;      // Must stay first, entry.S relies on it
+    uint32_t tid;
+    char name[16];
+    volatile thread_state_t state;
+    volatile uint32_t on_cpu;   // Context still live on a core, not yet saved
+    uint32_t wake_pending;      // thread_wake() arrived while running
+    int pinned_cpu;             // SCHED_ANY_CPU or the only core it may run on
+    unsigned int cpu;           // Core whose run queue owns the thread
+    uint32_t slice;             // Ticks left in the current time slice
+    uint32_t preempt_count;     // Preemption is off while non-zero
+    uint64_t run_ticks;
+    void* stack;
+    spinlock_t lock;            // Serializes block/wake transitions
+    struct thread* rq_next;
+    struct thread* rq_prev;
+    struct thread* all_next;
+    uint64_t wake_at;           // ktime_get_ns() deadline while on the sleep list
+    struct thread* sleep_next;
+    struct thread* wait_next;   // Next waiter on a mutex_t
+} thread_t;
+
+// Set up run queues and adopt the boot context as the "main" thread
+void sched_init(void);
+
+// Adopt a secondary core's boot context as its idle thread and start
+// scheduling on it. Never returns.
+void sched_start_cpu(void) __attribute__((noreturn));
+
+// Create a runnable kernel thread on the given core or SCHED_ANY_CPU
+thread_t* thread_create_on(const char* name, thread_fn_t fn, void* arg, int cpu);
+
+// Create a runnable kernel thread on the least loaded core
+thread_t* thread_create(const char* name, thread_fn_t fn, void* arg);
+
+// Terminate the calling thread
+void thread_exit(void) __attribute__((noreturn));
+
+// Thread running on the calling core
+thread_t* thread_current(void);
+
+// Sleep until thread_wake(); returns at once if a wake-up is already pending
+void thread_block(void);
+
+// Make a blocked thread runnable. Safe to call from IRQ context.
+void thread_wake(thread_t* thread);
+
+// Sleep for at least ns nanoseconds. Sleepers are woken from the scheduler
+// tick, so the resolution is one tick; with IRQs masked or no tick the
+// thread yields until the time has passed instead.
+void thread_sleep_ns(uint64_t ns);
+
+// Sleep until thread_wake() or until ns nanoseconds pass, at tick
+// resolution. Returns false once the time is up. Like thread_block() it can
+// return early, so callers recheck what they are waiting for.
+bool thread_block_timeout(uint64_t ns);
+
+// Give up the CPU to the next runnable thread
+void sched_yield(void);
+
+// Pick the next thread and switch to it
+void schedule(void);
+
+// Timer tick, called from the IRQ handler on every core
+void sched_tick(void);
+
+// Preempt on IRQ return if the tick asked for it; called from entry.S
+void sched_preempt_irq(void);
+
+// Finish a context switch on the new thread; called from entry.S
+void schedule_tail(thread_t* prev);
+
+// Disable and re-enable preemption of the calling thread
+void preempt_disable(void);
+void preempt_enable(void);
+
+// Display run queue and thread statistics
+void sched_stats(void);
+
+#endif // SCHED_H
@@ -0,0 +1,54 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include "types.h"
+#include "spinlock.h"
+#include <stdbool.h>
+
+// Sequence lock for small, frequently read data. Readers take no lock:
+// they copy the data and retry if a writer was active meanwhile. Writers
+// serialize on the spinlock and keep the sequence odd while writing.
+// Writers must not be interrupted by readers on the same core, so take
+// the write side with IRQs masked if the data is read from IRQ context.
+typedef struct {
+    volatile uint32_t sequence;
+    spinlock_t lock;
+} seqlock_t;
+
+#define SEQLOCK_INIT { 0, SPINLOCK_INIT }
+
+static inline void write_seqlock(seqlock_t* sl) {
+    spin_lock(&sl->lock);
+    __atomic_store_n(&sl->sequence, sl->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void write_sequnlock(seqlock_t* sl) {
+    __atomic_store_n(&sl->sequence, sl->sequence + 1, __ATOMIC_RELEASE);
+    spin_unlock(&sl->lock);
+}
+
+// Start a read; spins while a write is in progress
+static inline uint32_t read_seqbegin(const seqlock_t* sl) {
+    uint32_t seq;
+    while ((seq = __atomic_load_n(&sl->sequence, __ATOMIC_ACQUIRE)) & 1) {
+        cpu_relax();
+    }
+    return seq;
+}
+
+// Whether the data read since read_seqbegin() may be torn
+static inline bool read_seqretry(const seqlock_t* sl, uint32_t seq) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&sl->sequence, __ATOMIC_RELAXED) != seq;
+}
+
+#endif // SEQLOCK_H
@@ -8,6 +8,10 @@
 #include "shell.h"
 #include "../drivers/uart.h"
 #include "memory.h"
+#include "slab.h"
+#include "dma_pool.h"
+#include "bench.h"
+#include "sched.h"
 #include "types.h"
 #include "stdio.h"
 #include "ai/ai_subsystem.h"
@@ -18,9 +22,10 @@
 // Shell prompt
 static const char* PROMPT = "sage> ";
 
-// Command history
+// Command history, entries allocated on first use
 #define HISTORY_SIZE 10
-static char history[HISTORY_SIZE][MAX_COMMAND_LENGTH];
+static kmem_cache_t* history_cache = NULL;
+static char* history[HISTORY_SIZE];
 static int history_count = 0;
 static int history_index = 0;
 
@@ -41,6 +46,8 @@ static void cmd_meminfo(int argc, char* argv[]);
 static void cmd_reboot(int argc, char* argv[]);
 static void cmd_version(int argc, char* argv[]);
 static void cmd_ai(int argc, char* argv[]);
+static void cmd_bench(int argc, char* argv[]);
+static void cmd_ps(int argc, char* argv[]);
 
 // Command table
 static const command_t commands[] = {
@@ -51,11 +58,15 @@ static const command_t commands[] = {
     {"reboot",  "Reboot the system",                  cmd_reboot},
     {"version", "Display OS version information",     cmd_version},
     {"ai",      "AI subsystem commands",              cmd_ai},
+    {"bench",   "Run performance benchmarks",         cmd_bench},
+    {"ps",      "Display threads and run queues",     cmd_ps},
     {NULL, NULL, NULL}  // Terminator
 };
 
 // Initialize the shell
 void shell_init() {
+    history_cache = kmem_cache_create("shell_history", MAX_COMMAND_LENGTH, 0, NULL);
+    
     uart_puts("SAGE OS Shell initialized\n");
     
     // Initialize AI subsystem
@@ -108,10 +119,18 @@ static void add_to_history(const char* command) {
     }
     
     // Check if this command is the same as the last one
-    if (history_count > 0 && strcmp(command, history[(history_index - 1) % HISTORY_SIZE]) == 0) {
+    if (history_count > 0 && strcmp(command, history[(history_index + HISTORY_SIZE - 1) % HISTORY_SIZE]) == 0) {
         return;  // Don't add duplicate commands consecutively
     }
     
+    // Allocate the slot the first time it is used
+    if (history[history_index] == NULL) {
+        history[history_index] = (char*)kmem_cache_alloc(history_cache);
+        if (history[history_index] == NULL) {
+            return;
+        }
+    }
+    
     strcpy(history[history_index], command);
     history_index = (history_index + 1) % HISTORY_SIZE;
     if (history_count < HISTORY_SIZE) {
@@ -226,6 +245,8 @@ static void cmd_clear(int argc, char* argv[]) {
 
 static void cmd_meminfo(int argc, char* argv[]) {
     memory_stats();
+    slab_stats();
+    dma_pool_stats();
 }
 
 static void cmd_reboot(int argc, char* argv[]) {
@@ -255,6 +276,42 @@ static void cmd_version(int argc, char* argv[]) {
     uart_puts("Copyright (c) 2025 SAGE OS Team\n");
 }
 
+// Load a model of each stock type and allocate its zero-copy tensors
+static void cmd_ai_buffers(void) {
+    static const char* names[] = { "Classification", "Detection", "Segmentation", "Generation" };
+    
+    uint8_t* weights = (uint8_t*)page_alloc(0);
+    if (weights == NULL) {
+        uart_puts("ai: out of memory\n");
+        return;
+    }
+    memset(weights, 0xA5, PAGE_SIZE);
+    
+    uart_puts("AI zero-copy buffers:\n");
+    for (uint32_t type = AI_MODEL_TYPE_CLASSIFICATION; type <= AI_MODEL_TYPE_GENERATION; type++) {
+        ai_model_descriptor_t model;
+        ai_subsystem_status_t status = ai_subsystem_load_model(weights, PAGE_SIZE, (ai_model_type_t)type, &model);
+        if (status != AI_SUBSYSTEM_SUCCESS) {
+            uart_printf("  %-14s: load failed (%d)\n", names[type], (int)status);
+            continue;
+        }
+        
+        ai_io_buffer_t buffer;
+        status = ai_subsystem_buffer_create(model.id, &buffer);
+        if (status == AI_SUBSYSTEM_SUCCESS) {
+            uart_printf("  %-14s: ok, %u + %u bytes\n", names[type],
+                        (unsigned int)buffer.input_size, (unsigned int)buffer.output_size);
+            ai_subsystem_buffer_destroy(&buffer);
+        } else {
+            uart_printf("  %-14s: FAILED (%d)\n", names[type], (int)status);
+        }
+        
+        ai_subsystem_unload_model(model.id);
+    }
+    
+    page_free(weights);
+}
+
 // AI command handler
 static void cmd_ai(int argc, char* argv[]) {
     if (argc < 2) {
@@ -263,6 +320,8 @@ static void cmd_ai(int argc, char* argv[]) {
         uart_puts("  temp     - Show AI HAT+ temperature\n");
         uart_puts("  power    - Show AI HAT+ power consumption\n");
         uart_puts("  models   - List loaded AI models\n");
+        uart_puts("  cache    - Show AI model residency counters\n");
+        uart_puts("  buffers  - Check zero-copy buffers for each stock model\n");
         return;
     }
     
@@ -321,6 +380,21 @@ static void cmd_ai(int argc, char* argv[]) {
         } else {
             uart_puts("Failed to get AI HAT+ power consumption\n");
         }
+    } else if (strcmp(argv[1], "cache") == 0) {
+        ai_residency_stats_t stats;
+        ai_subsystem_status_t status = ai_subsystem_get_residency_stats(&stats);
+        
+        if (status == AI_SUBSYSTEM_SUCCESS) {
+            uart_puts("AI model residency:\n");
+            uart_printf("  Resident: %u models, %u of %u KB\n", (unsigned int)stats.resident_models,
+                        (unsigned int)(stats.resident_bytes / 1024), (unsigned int)(stats.capacity_bytes / 1024));
+            uart_printf("  Hits: %llu  Misses: %llu  Evictions: %llu\n", (unsigned long long)stats.hits,
+                        (unsigned long long)stats.misses, (unsigned long long)stats.evictions);
+        } else {
+            uart_puts("Failed to get AI model residency\n");
+        }
+    } else if (strcmp(argv[1], "buffers") == 0) {
+        cmd_ai_buffers();
     } else if (strcmp(argv[1], "models") == 0) {
         ai_model_descriptor_t models[8];
         uint32_t num_models;
@@ -392,4 +466,36 @@ static void cmd_ai(int argc, char* argv[]) {
         uart_printf("Unknown AI command: %s\n", argv[1]);
         uart_puts("Type 'ai' for a list of AI commands\n");
     }
+}
+
+// Benchmark command handler
+static void cmd_bench(int argc, char* argv[]) {
+    if (argc < 2) {
+        uart_puts("Benchmarks:\n");
+        uart_puts("  memcpy   - memcpy throughput by copy size\n");
+        uart_puts("  mem      - memcpy/memset/memmove vs byte loops, bytes/cycle\n");
+        uart_puts("  str      - strlen/strcmp/strcpy/strncpy vs byte loops\n");
+        uart_puts("  ai       - AI inference throughput, single-shot vs batched\n");
+        return;
+    }
+    
+    if (strcmp(argv[1], "memcpy") == 0) {
+        bench_memcpy();
+    } else if (strcmp(argv[1], "mem") == 0) {
+        bench_mem_sweep();
+    } else if (strcmp(argv[1], "str") == 0) {
+        bench_str_sweep();
+    } else if (strcmp(argv[1], "ai") == 0) {
+        bench_ai_batch();
+    } else {
+        uart_printf("Unknown benchmark: %s\n", argv[1]);
+        uart_puts("Type 'bench' for a list of benchmarks\n");
+    }
+}
+
+// Thread status command handler
+static void cmd_ps(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+    sched_stats();
 }
\ No newline at end of file
@@ -0,0 +1,303 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "slab.h"
+#include "memory.h"
+#include "spinlock.h"
+#include "../drivers/uart.h"
+
+// Aim for at least this many objects per slab before growing the slab order
+#define SLAB_MIN_OBJECTS 8
+
+// Slab header, stored at the start of every slab. Slabs are buddy blocks, so
+// they are aligned to their own size and an object's slab is found by masking.
+typedef struct slab {
+    kmem_cache_t* cache;
+    struct slab* next;
+    struct slab* prev;
+    void* free_list;        // Free objects, linked through their first word
+    uint32_t inuse;
+} slab_t;
+
+struct kmem_cache {
+    spinlock_t lock;        // Protects the slab lists and counters
+    const char* name;
+    size_t object_size;     // Size requested by the creator
+    size_t stride;          // Object size rounded up to the alignment
+    size_t first_offset;    // Offset of the first object in a slab
+    unsigned int slab_order;
+    uint32_t objects_per_slab;
+    kmem_ctor_t ctor;
+
+    slab_t* partial;        // Slabs with free and used objects
+    slab_t* full;           // Slabs with no free objects
+    slab_t* empty;          // At most one fully free slab kept for reuse
+
+    size_t num_slabs;
+    size_t active_objects;
+    struct kmem_cache* next_cache;
+};
+
+// Cache descriptors are themselves allocated from this bootstrap cache
+static struct kmem_cache cache_cache;
+static kmem_cache_t* cache_list = NULL;
+static spinlock_t cache_list_lock = SPINLOCK_INIT;
+
+static inline size_t align_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+static void slab_list_add(slab_t** head, slab_t* slab) {
+    slab->prev = NULL;
+    slab->next = *head;
+    if (*head) {
+        (*head)->prev = slab;
+    }
+    *head = slab;
+}
+
+static void slab_list_remove(slab_t** head, slab_t* slab) {
+    if (slab->prev) {
+        slab->prev->next = slab->next;
+    } else {
+        *head = slab->next;
+    }
+    if (slab->next) {
+        slab->next->prev = slab->prev;
+    }
+    slab->next = NULL;
+    slab->prev = NULL;
+}
+
+static inline slab_t* slab_of(kmem_cache_t* cache, void* obj) {
+    return (slab_t*)((uintptr_t)obj & ~((PAGE_SIZE << cache->slab_order) - 1));
+}
+
+// Compute the slab geometry of a cache. Returns 0 if the object cannot fit.
+static int cache_setup(kmem_cache_t* cache, const char* name, size_t size, size_t align, kmem_ctor_t ctor) {
+    if (align < CACHE_LINE_SIZE) {
+        align = CACHE_LINE_SIZE;
+    }
+    if (size < sizeof(void*)) {
+        size = sizeof(void*);
+    }
+
+    spin_lock_init(&cache->lock);
+    cache->name = name;
+    cache->object_size = size;
+    cache->stride = align_up(size, align);
+    cache->first_offset = align_up(sizeof(slab_t), align);
+    cache->ctor = ctor;
+    cache->partial = NULL;
+    cache->full = NULL;
+    cache->empty = NULL;
+    cache->num_slabs = 0;
+    cache->active_objects = 0;
+
+    unsigned int order = 0;
+    while (order < MAX_ORDER - 1 &&
+           ((PAGE_SIZE << order) - cache->first_offset) / cache->stride < SLAB_MIN_OBJECTS) {
+        order++;
+    }
+
+    size_t slab_bytes = PAGE_SIZE << order;
+    if (cache->first_offset + cache->stride > slab_bytes) {
+        return 0;
+    }
+
+    cache->slab_order = order;
+    cache->objects_per_slab = (slab_bytes - cache->first_offset) / cache->stride;
+
+    spin_lock(&cache_list_lock);
+    cache->next_cache = cache_list;
+    cache_list = cache;
+    spin_unlock(&cache_list_lock);
+    return 1;
+}
+
+// Allocate a new slab and thread its objects onto the free list
+static slab_t* cache_grow(kmem_cache_t* cache) {
+    slab_t* slab = (slab_t*)page_alloc(cache->slab_order);
+    if (slab == NULL) {
+        return NULL;
+    }
+
+    slab->cache = cache;
+    slab->next = NULL;
+    slab->prev = NULL;
+    slab->inuse = 0;
+    slab->free_list = NULL;
+
+    // Link objects back to front so allocation walks memory upwards
+    uint8_t* first = (uint8_t*)slab + cache->first_offset;
+    for (uint32_t i = cache->objects_per_slab; i > 0; i--) {
+        void** obj = (void**)(first + (i - 1) * cache->stride);
+        *obj = slab->free_list;
+        slab->free_list = obj;
+    }
+
+    cache->num_slabs++;
+    return slab;
+}
+
+// Create a cache of fixed-size objects
+kmem_cache_t* kmem_cache_create(const char* name, size_t size, size_t align, kmem_ctor_t ctor) {
+    if (size == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+
+    // Bootstrap the cache of cache descriptors on first use
+    if (__atomic_load_n(&cache_cache.stride, __ATOMIC_ACQUIRE) == 0) {
+        static spinlock_t bootstrap_lock = SPINLOCK_INIT;
+        spin_lock(&bootstrap_lock);
+        if (cache_cache.stride == 0) {
+            cache_setup(&cache_cache, "kmem_cache", sizeof(struct kmem_cache), 0, NULL);
+        }
+        spin_unlock(&bootstrap_lock);
+    }
+
+    kmem_cache_t* cache = (kmem_cache_t*)kmem_cache_alloc(&cache_cache);
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    if (!cache_setup(cache, name, size, align, ctor)) {
+        kmem_cache_free(&cache_cache, cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+// Allocate one object in O(1)
+void* kmem_cache_alloc(kmem_cache_t* cache) {
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    spin_lock(&cache->lock);
+
+    slab_t* slab = cache->partial;
+    if (slab == NULL) {
+        slab = cache->empty;
+        if (slab != NULL) {
+            slab_list_remove(&cache->empty, slab);
+        } else {
+            slab = cache_grow(cache);
+            if (slab == NULL) {
+                spin_unlock(&cache->lock);
+                return NULL;
+            }
+        }
+        slab_list_add(&cache->partial, slab);
+    }
+
+    void** obj = (void**)slab->free_list;
+    slab->free_list = *obj;
+    slab->inuse++;
+
+    if (slab->inuse == cache->objects_per_slab) {
+        slab_list_remove(&cache->partial, slab);
+        slab_list_add(&cache->full, slab);
+    }
+
+    cache->active_objects++;
+
+    spin_unlock(&cache->lock);
+
+    if (cache->ctor) {
+        cache->ctor(obj);
+    }
+
+    return obj;
+}
+
+// Return an object to its slab in O(1)
+void kmem_cache_free(kmem_cache_t* cache, void* obj) {
+    if (cache == NULL || obj == NULL) {
+        return;
+    }
+
+    slab_t* slab = slab_of(cache, obj);
+    if (slab->cache != cache) {
+        uart_printf("kmem_cache_free: object does not belong to cache %s\n", cache->name);
+        return;
+    }
+
+    spin_lock(&cache->lock);
+
+    if (slab->inuse == cache->objects_per_slab) {
+        slab_list_remove(&cache->full, slab);
+    } else {
+        slab_list_remove(&cache->partial, slab);
+    }
+
+    *(void**)obj = slab->free_list;
+    slab->free_list = obj;
+    slab->inuse--;
+    cache->active_objects--;
+
+    slab_t* release = NULL;
+    if (slab->inuse > 0) {
+        slab_list_add(&cache->partial, slab);
+    } else if (cache->empty == NULL) {
+        slab_list_add(&cache->empty, slab);
+    } else {
+        // Keep a single empty slab around; give the rest back
+        cache->num_slabs--;
+        release = slab;
+    }
+
+    spin_unlock(&cache->lock);
+
+    if (release != NULL) {
+        page_free(release);
+    }
+}
+
+// Release every slab of an empty cache and the cache itself
+void kmem_cache_destroy(kmem_cache_t* cache) {
+    if (cache == NULL || cache == &cache_cache) {
+        return;
+    }
+
+    if (cache->active_objects != 0) {
+        uart_printf("kmem_cache_destroy: cache %s still has live objects\n", cache->name);
+        return;
+    }
+
+    while (cache->empty) {
+        slab_t* slab = cache->empty;
+        slab_list_remove(&cache->empty, slab);
+        page_free(slab);
+    }
+
+    // Unlink from the cache list
+    spin_lock(&cache_list_lock);
+    kmem_cache_t** link = &cache_list;
+    while (*link && *link != cache) {
+        link = &(*link)->next_cache;
+    }
+    if (*link) {
+        *link = cache->next_cache;
+    }
+    spin_unlock(&cache_list_lock);
+
+    kmem_cache_free(&cache_cache, cache);
+}
+
+// Display per-cache statistics
+void slab_stats() {
+    uart_puts("Slab caches:\n");
+    spin_lock(&cache_list_lock);
+    for (kmem_cache_t* cache = cache_list; cache != NULL; cache = cache->next_cache) {
+        uart_printf("  %s: %d bytes, %d/%d objects, %d slabs\n",
+                    cache->name, (int)cache->object_size, (int)cache->active_objects,
+                    (int)(cache->num_slabs * cache->objects_per_slab), (int)cache->num_slabs);
+    }
+    spin_unlock(&cache_list_lock);
+}
@@ -0,0 +1,38 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "types.h"
+
+// Objects are never packed tighter than one cache line
+#define CACHE_LINE_SIZE 64
+
+// Optional per-object constructor, run on every kmem_cache_alloc()
+typedef void (*kmem_ctor_t)(void* obj);
+
+// Opaque object cache
+typedef struct kmem_cache kmem_cache_t;
+
+// Create a cache of fixed-size objects. align of 0 means CACHE_LINE_SIZE.
+kmem_cache_t* kmem_cache_create(const char* name, size_t size, size_t align, kmem_ctor_t ctor);
+
+// Allocate one object, or NULL if the page allocator is exhausted
+void* kmem_cache_alloc(kmem_cache_t* cache);
+
+// Return an object to the cache it came from
+void kmem_cache_free(kmem_cache_t* cache, void* obj);
+
+// Release every slab of an empty cache and the cache itself
+void kmem_cache_destroy(kmem_cache_t* cache);
+
+// Display per-cache statistics
+void slab_stats();
+
+#endif // SLAB_H
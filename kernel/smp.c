@@ -0,0 +1,115 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "smp.h"
+#include "mmu.h"
+#include "spinlock.h"
+#include "sched.h"
+#include "../drivers/uart.h"
+
+// Raspberry Pi spin table: the firmware stub parks core n polling the 64-bit
+// word at 0xD8 + 8 * n and jumps to it once it becomes non-zero. Cores that
+// enter _start directly poll the same slots.
+#define SPIN_TABLE_BASE     0xD8UL
+
+// PSCI 0.2 CPU_ON, used instead of the spin table when built with
+// -DSMP_USE_PSCI (QEMU virt and other PSCI firmware)
+#define PSCI_CPU_ON_64      0xC4000003UL
+
+// Polling iterations to wait for a core to report in
+#define SMP_BOOT_TIMEOUT    10000000
+
+static volatile bool cpu_online[NR_CPUS];
+
+// Secondary entry point in boot.S
+extern char secondary_entry[];
+
+#if defined(__aarch64__)
+// Start a secondary core at secondary_entry
+static bool smp_boot_cpu(unsigned int cpu) {
+#if defined(SMP_USE_PSCI)
+    register uint64_t x0 asm("x0") = PSCI_CPU_ON_64;
+    register uint64_t x1 asm("x1") = cpu;
+    register uint64_t x2 asm("x2") = (uint64_t)secondary_entry;
+    register uint64_t x3 asm("x3") = 0;
+    asm volatile("hvc #0" : "+r"(x0) : "r"(x1), "r"(x2), "r"(x3) : "memory");
+    return (int64_t)x0 == 0;
+#else
+    volatile uint64_t* mailbox = (volatile uint64_t*)(SPIN_TABLE_BASE + cpu * 8);
+    *mailbox = (uint64_t)secondary_entry;
+
+    // The parked core reads the mailbox with its MMU off, so push the line
+    // out to memory before waking it
+    asm volatile("dc civac, %0\n"
+                 "dsb sy\n"
+                 "sev" :: "r"(mailbox) : "memory");
+    return true;
+#endif
+}
+#endif
+
+// Release the secondary cores and wait for them to come online
+void smp_init(void) {
+    cpu_online[0] = true;
+
+#if defined(__aarch64__)
+    for (unsigned int cpu = 1; cpu < NR_CPUS; cpu++) {
+        if (!smp_boot_cpu(cpu)) {
+            uart_printf("SMP: failed to start core %d\n", cpu);
+            continue;
+        }
+
+        for (int timeout = SMP_BOOT_TIMEOUT; timeout > 0 && !cpu_online[cpu]; timeout--) {
+            cpu_relax();
+        }
+
+        if (!cpu_online[cpu]) {
+            uart_printf("SMP: core %d did not come online\n", cpu);
+        }
+    }
+#endif
+
+    uart_printf("SMP: %d cores online\n", smp_num_online());
+}
+
+// Index of the calling core
+unsigned int smp_processor_id(void) {
+#if defined(__aarch64__)
+    uint64_t mpidr;
+    asm volatile("mrs %0, mpidr_el1" : "=r"(mpidr));
+    return mpidr & 0xFF;
+#else
+    return 0;
+#endif
+}
+
+// Number of cores that have completed bring-up
+unsigned int smp_num_online(void) {
+    unsigned int count = 0;
+    for (unsigned int cpu = 0; cpu < NR_CPUS; cpu++) {
+        if (cpu_online[cpu]) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Whether a core has completed bring-up
+bool smp_cpu_online(unsigned int cpu) {
+    return cpu < NR_CPUS && cpu_online[cpu];
+}
+
+// C entry point for secondary cores
+void secondary_main(uint64_t cpu) {
+    // Join the boot core's address space before touching shared data
+    mmu_enable();
+
+    __atomic_store_n(&cpu_online[cpu], true, __ATOMIC_RELEASE);
+
+    // Become this core's idle thread and start taking work
+    sched_start_cpu();
+}
@@ -0,0 +1,33 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef SMP_H
+#define SMP_H
+
+#include "types.h"
+#include <stdbool.h>
+
+// Number of cores supported; must match NR_CPUS in boot/boot.S
+#define NR_CPUS 4
+
+// Release the secondary cores and wait for them to come online
+void smp_init(void);
+
+// Index of the calling core
+unsigned int smp_processor_id(void);
+
+// Number of cores that have completed bring-up
+unsigned int smp_num_online(void);
+
+// Whether a core has completed bring-up
+bool smp_cpu_online(unsigned int cpu);
+
+// C entry point for secondary cores, called from boot.S with a private stack
+void secondary_main(uint64_t cpu) __attribute__((noreturn));
+
+#endif // SMP_H
@@ -0,0 +1,54 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+#include "types.h"
+
+// Test-and-test-and-set spinlock. On AArch64 the exclusives only work once
+// the MMU maps the lock as cacheable memory, so cores must call mmu_enable()
+// before taking any lock.
+typedef struct {
+    volatile uint32_t locked;
+} spinlock_t;
+
+#define SPINLOCK_INIT { 0 }
+
+// Hint to the core that it is spinning
+static inline void cpu_relax(void) {
+#if defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#elif defined(__x86_64__)
+    asm volatile("pause" ::: "memory");
+#else
+    asm volatile("" ::: "memory");
+#endif
+}
+
+static inline void spin_lock_init(spinlock_t* lock) {
+    lock->locked = 0;
+}
+
+static inline void spin_lock(spinlock_t* lock) {
+    while (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED)) {
+            cpu_relax();
+        }
+    }
+}
+
+static inline int spin_trylock(spinlock_t* lock) {
+    return !__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE);
+}
+
+static inline void spin_unlock(spinlock_t* lock) {
+    __atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+#endif // SPINLOCK_H
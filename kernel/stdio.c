@@ -69,74 +69,723 @@
 //
 
 #include "stdio.h"
+#include "types.h"
+#include "irq.h"
+#include "mmu.h"
+#include "sched.h"
+#include <stdbool.h>
+
+// Word-at-a-time helpers. may_alias lets the word accesses overlap any
+// object type; aligned(1) makes unaligned loads legal C (a single ldr on
+// AArch64 and x86, split loads where the hardware needs them).
+typedef uint64_t __attribute__((may_alias)) word_t;
+typedef uint64_t __attribute__((may_alias, aligned(1))) unaligned_word_t;
+
+#define WORD_SIZE           sizeof(word_t)
+#define WORD_MASK           (WORD_SIZE - 1)
+
+// SWAR zero-byte detection: non-zero iff some byte of x is zero. The
+// string routines below rely on little-endian byte order.
+#define ONES                0x0101010101010101ULL
+#define HIGHS               0x8080808080808080ULL
+#define HAS_ZERO(x)         (((x) - ONES) & ~(x) & HIGHS)
+
+_Static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+               "SWAR string routines assume little-endian");
+
+// Below this, plain byte loops beat the setup cost
+#define MEM_SMALL           16
+
+// SIMD copies and DC ZVA zeroing only pay off for larger blocks
+#define MEMCPY_SIMD_MIN     256
+#define MEMSET_ZVA_MIN      512
+
+// Keep GCC from turning these loops back into calls to themselves
+#define MEM_NO_LIBCALL      __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+#if defined(__aarch64__)
+extern void __memcpy_simd(void* dest, const void* src, size_t n);
+
+// SIMD registers are not preserved across IRQs or context switches, so
+// they may only be used from thread context with preemption disabled
+static inline bool simd_usable(void) {
+    return !irq_disabled();
+}
+
+// DC ZVA block size in bytes, or 0 if the instruction is prohibited
+static size_t zva_block_size(void) {
+    static size_t block = (size_t)-1;
+    if (block == (size_t)-1) {
+        uint64_t dczid;
+        asm volatile("mrs %0, dczid_el0" : "=r"(dczid));
+        block = (dczid & (1 << 4)) ? 0 : (size_t)4 << (dczid & 0xF);
+    }
+    return block;
+}
+#endif
+
+// Memory set
+MEM_NO_LIBCALL
+void* memset(void* ptr, int value, size_t num) {
+    unsigned char* p = (unsigned char*)ptr;
+    unsigned char byte = (unsigned char)value;
+
+    if (num >= MEM_SMALL) {
+        while ((uintptr_t)p & WORD_MASK) {
+            *p++ = byte;
+            num--;
+        }
+
+#if defined(__aarch64__)
+        // Zero whole cache blocks without reading them first. DC ZVA
+        // faults on Device memory, so only use it with the MMU and caches on.
+        size_t block = zva_block_size();
+        if (byte == 0 && block && num >= MEMSET_ZVA_MIN && num >= 2 * block && mmu_enabled()) {
+            while ((uintptr_t)p & (block - 1)) {
+                *(word_t*)p = 0;
+                p += WORD_SIZE;
+                num -= WORD_SIZE;
+            }
+            while (num >= block) {
+                asm volatile("dc zva, %0" :: "r"(p) : "memory");
+                p += block;
+                num -= block;
+            }
+        }
+#endif
+
+        word_t pattern = byte * 0x0101010101010101ULL;
+        while (num >= 4 * WORD_SIZE) {
+            ((word_t*)p)[0] = pattern;
+            ((word_t*)p)[1] = pattern;
+            ((word_t*)p)[2] = pattern;
+            ((word_t*)p)[3] = pattern;
+            p += 4 * WORD_SIZE;
+            num -= 4 * WORD_SIZE;
+        }
+        while (num >= WORD_SIZE) {
+            *(word_t*)p = pattern;
+            p += WORD_SIZE;
+            num -= WORD_SIZE;
+        }
+    }
+
+    while (num--) {
+        *p++ = byte;
+    }
+    return ptr;
+}
+
+// Copy forwards a word at a time; safe for overlap only when dest < src
+MEM_NO_LIBCALL
+static void copy_forward(unsigned char* d, const unsigned char* s, size_t n) {
+    if (n >= MEM_SMALL) {
+        while ((uintptr_t)d & WORD_MASK) {
+            *d++ = *s++;
+            n--;
+        }
+
+        // Destination is aligned; the source may not be
+        while (n >= 4 * WORD_SIZE) {
+            word_t w0 = ((const unaligned_word_t*)s)[0];
+            word_t w1 = ((const unaligned_word_t*)s)[1];
+            word_t w2 = ((const unaligned_word_t*)s)[2];
+            word_t w3 = ((const unaligned_word_t*)s)[3];
+            ((word_t*)d)[0] = w0;
+            ((word_t*)d)[1] = w1;
+            ((word_t*)d)[2] = w2;
+            ((word_t*)d)[3] = w3;
+            d += 4 * WORD_SIZE;
+            s += 4 * WORD_SIZE;
+            n -= 4 * WORD_SIZE;
+        }
+        while (n >= WORD_SIZE) {
+            *(word_t*)d = *(const unaligned_word_t*)s;
+            d += WORD_SIZE;
+            s += WORD_SIZE;
+            n -= WORD_SIZE;
+        }
+    }
+
+    while (n--) {
+        *d++ = *s++;
+    }
+}
+
+// Copy backwards a word at a time; for overlapping moves with dest > src
+MEM_NO_LIBCALL
+static void copy_backward(unsigned char* d, const unsigned char* s, size_t n) {
+    d += n;
+    s += n;
+
+    if (n >= MEM_SMALL) {
+        while ((uintptr_t)d & WORD_MASK) {
+            *--d = *--s;
+            n--;
+        }
+        while (n >= WORD_SIZE) {
+            d -= WORD_SIZE;
+            s -= WORD_SIZE;
+            n -= WORD_SIZE;
+            *(word_t*)d = *(const unaligned_word_t*)s;
+        }
+    }
+
+    while (n--) {
+        *--d = *--s;
+    }
+}
+
+// Memory copy
+void* memcpy(void* dest, const void* src, size_t n) {
+#if defined(__aarch64__)
+    if (n >= MEMCPY_SIMD_MIN && simd_usable()) {
+        preempt_disable();
+        __memcpy_simd(dest, src, n);
+        preempt_enable();
+        return dest;
+    }
+#endif
+
+    copy_forward((unsigned char*)dest, (const unsigned char*)src, n);
+    return dest;
+}
+
+// Memory copy between possibly overlapping regions
+void* memmove(void* dest, const void* src, size_t n) {
+    unsigned char* d = (unsigned char*)dest;
+    const unsigned char* s = (const unsigned char*)src;
+
+    if (d == s || n == 0) {
+        return dest;
+    }
+
+    if (d + n <= s || s + n <= d) {
+        return memcpy(dest, src, n);
+    }
+
+    // Word copies read ahead of what they write only in the copy direction
+    if (d < s) {
+        copy_forward(d, s, n);
+    } else {
+        copy_backward(d, s, n);
+    }
+    return dest;
+}
+
+// Memory compare
+int memcmp(const void* ptr1, const void* ptr2, size_t n) {
+    const unsigned char* a = (const unsigned char*)ptr1;
+    const unsigned char* b = (const unsigned char*)ptr2;
+
+    // Skip equal words, then locate the differing byte
+    while (n >= WORD_SIZE &&
+           *(const unaligned_word_t*)a == *(const unaligned_word_t*)b) {
+        a += WORD_SIZE;
+        b += WORD_SIZE;
+        n -= WORD_SIZE;
+    }
+
+    while (n--) {
+        if (*a != *b) {
+            return *a - *b;
+        }
+        a++;
+        b++;
+    }
+    return 0;
+}
+
+// The string routines read whole aligned words. An aligned word never
+// spans a page, so reading past the terminator can never fault.
 
 // String length
 size_t strlen(const char* str) {
-    size_t len = 0;
-    while (str[len]) {
-        len++;
+    uintptr_t offset = (uintptr_t)str & WORD_MASK;
+    const word_t* p = (const word_t*)(str - offset);
+
+    // Bytes before str in the first word must not look like terminators
+    word_t w = *p | ((1ULL << (offset * 8)) - 1);
+    while (!HAS_ZERO(w)) {
+        w = *++p;
     }
-    return len;
+
+    // First zero byte: the lowest byte whose high bit HAS_ZERO() set.
+    // Borrows only propagate upwards, so the lowest flag is exact.
+    size_t index = __builtin_ctzll(HAS_ZERO(w)) / 8;
+    return (const char*)p + index - str;
 }
 
 // String comparison
 int strcmp(const char* str1, const char* str2) {
-    while (*str1 && (*str1 == *str2)) {
-        str1++;
-        str2++;
+    const unsigned char* a = (const unsigned char*)str1;
+    const unsigned char* b = (const unsigned char*)str2;
+
+    // Bytes until a is aligned
+    while ((uintptr_t)a & WORD_MASK) {
+        if (*a != *b || *a == '\0') {
+            return *a - *b;
+        }
+        a++;
+        b++;
     }
-    return *(unsigned char*)str1 - *(unsigned char*)str2;
+
+    uintptr_t offset = (uintptr_t)b & WORD_MASK;
+    if (offset == 0) {
+        // Both aligned: compare while words match and hold no terminator
+        while (1) {
+            word_t wa = *(const word_t*)a;
+            word_t wb = *(const word_t*)b;
+            if (wa != wb || HAS_ZERO(wa)) {
+                break;
+            }
+            a += WORD_SIZE;
+            b += WORD_SIZE;
+        }
+    } else {
+        // b is misaligned: build its words from two aligned loads, and
+        // only load the next one once the current tail holds no terminator
+        unsigned int shift = offset * 8;
+        word_t tail_mask = ~(~0ULL >> shift);
+        const word_t* pb = (const word_t*)(b - offset);
+        word_t low = *pb++ >> shift;
+
+        while (!HAS_ZERO(low | tail_mask)) {
+            word_t next = *pb++;
+            word_t wb = low | (next << (64 - shift));
+            word_t wa = *(const word_t*)a;
+            if (wa != wb || HAS_ZERO(wa)) {
+                break;
+            }
+            a += WORD_SIZE;
+            b += WORD_SIZE;
+            low = next >> shift;
+        }
+    }
+
+    // The difference or terminator is within the next word
+    while (*a == *b && *a != '\0') {
+        a++;
+        b++;
+    }
+    return *a - *b;
+}
+
+// Copy words from an aligned source while they hold no terminator. Returns
+// the number of bytes copied; at most limit.
+static size_t copy_words_until_nul(char* dest, const char* src, size_t limit) {
+    size_t copied = 0;
+    while (limit - copied >= WORD_SIZE) {
+        word_t w = *(const word_t*)(src + copied);
+        if (HAS_ZERO(w)) {
+            break;
+        }
+        *(unaligned_word_t*)(dest + copied) = w;
+        copied += WORD_SIZE;
+    }
+    return copied;
 }
 
 // String copy
 char* strcpy(char* dest, const char* src) {
-    char* original_dest = dest;
-    while ((*dest++ = *src++));
-    return original_dest;
+    char* d = dest;
+
+    while ((uintptr_t)src & WORD_MASK) {
+        if ((*d++ = *src++) == '\0') {
+            return dest;
+        }
+    }
+
+    size_t copied = copy_words_until_nul(d, src, (size_t)-1);
+    d += copied;
+    src += copied;
+
+    while ((*d++ = *src++));
+    return dest;
 }
 
 // String copy with limit
 char* strncpy(char* dest, const char* src, size_t n) {
-    size_t i;
-    for (i = 0; i < n && src[i] != '\0'; i++) {
-        dest[i] = src[i];
+    size_t i = 0;
+
+    while (i < n && ((uintptr_t)(src + i) & WORD_MASK)) {
+        if ((dest[i] = src[i]) == '\0') {
+            break;
+        }
+        i++;
     }
-    for (; i < n; i++) {
-        dest[i] = '\0';
+
+    if (i < n && src[i] != '\0') {
+        i += copy_words_until_nul(dest + i, src + i, n - i);
+        for (; i < n && src[i] != '\0'; i++) {
+            dest[i] = src[i];
+        }
+    }
+
+    // Pad the rest with NULs as strncpy requires
+    if (i < n) {
+        memset(dest + i, 0, n - i);
     }
     return dest;
 }
 
-// Memory set
-void* memset(void* ptr, int value, size_t num) {
-    unsigned char* p = (unsigned char*)ptr;
-    while (num--) {
-        *p++ = (unsigned char)value;
+// Two-digit decimal strings "00".."99", for converting integers two
+// digits per division
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+#define FMT_LEFT        0x01    // '-'
+#define FMT_ZERO        0x02    // '0'
+#define FMT_PLUS        0x04    // '+'
+#define FMT_SPACE       0x08    // ' '
+#define FMT_ALT         0x10    // '#'
+#define FMT_UPPER       0x20
+
+// Output state for one formatting call
+typedef struct {
+    printf_sink_t sink;
+    void* ctx;
+    size_t count;
+} fmt_out_t;
+
+static inline void fmt_emit(fmt_out_t* out, const char* data, size_t len) {
+    if (len) {
+        out->sink(out->ctx, data, len);
+        out->count += len;
     }
-    return ptr;
 }
 
-// Memory copy
-void* memcpy(void* dest, const void* src, size_t n) {
-    char* d = (char*)dest;
-    const char* s = (const char*)src;
-    
-    for (size_t i = 0; i < n; i++) {
-        d[i] = s[i];
+// Emit len copies of c in chunks
+static void fmt_pad(fmt_out_t* out, char c, int len) {
+    static const char spaces[16] = "                ";
+    static const char zeros[16] = "0000000000000000";
+    const char* fill = (c == '0') ? zeros : spaces;
+
+    while (len > 0) {
+        int chunk = len > 16 ? 16 : len;
+        fmt_emit(out, fill, chunk);
+        len -= chunk;
     }
-    
-    return dest;
 }
 
-// Simple sprintf implementation
-int sprintf(char* str, const char* format, ...) {
-    // Very basic implementation - just copy format string for now
-    // In a real implementation, this would handle format specifiers
-    int i = 0;
-    while (format[i]) {
-        str[i] = format[i];
-        i++;
+// Convert to decimal, writing backwards from end; returns the start
+static char* fmt_decimal(char* end, uint64_t value) {
+    while (value >= 100) {
+        unsigned int pair = (unsigned int)(value % 100) * 2;
+        value /= 100;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        unsigned int pair = (unsigned int)value * 2;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    } else {
+        *--end = (char)('0' + value);
+    }
+    return end;
+}
+
+// Convert to a power-of-two base, writing backwards from end
+static char* fmt_pow2(char* end, uint64_t value, unsigned int shift, bool upper) {
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    uint64_t mask = (1U << shift) - 1;
+    do {
+        *--end = digits[value & mask];
+        value >>= shift;
+    } while (value);
+    return end;
+}
+
+// Emit a converted number with sign/prefix, precision and width applied
+static void fmt_number(fmt_out_t* out, uint64_t value, bool negative, char conv,
+                       int flags, int width, int precision) {
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* digits;
+    const char* prefix = "";
+    size_t prefix_len = 0;
+
+    if (conv == 'x' || conv == 'X' || conv == 'p') {
+        digits = fmt_pow2(end, value, 4, flags & FMT_UPPER);
+        if ((flags & FMT_ALT) && value != 0) {
+            prefix = (flags & FMT_UPPER) ? "0X" : "0x";
+            prefix_len = 2;
+        }
+    } else if (conv == 'o') {
+        digits = fmt_pow2(end, value, 3, false);
+        if ((flags & FMT_ALT) && *digits != '0') {
+            *--digits = '0';
+        }
+    } else {
+        digits = fmt_decimal(end, value);
+        if (negative) {
+            prefix = "-";
+            prefix_len = 1;
+        } else if (flags & FMT_PLUS) {
+            prefix = "+";
+            prefix_len = 1;
+        } else if (flags & FMT_SPACE) {
+            prefix = " ";
+            prefix_len = 1;
+        }
+    }
+
+    int len = (int)(end - digits);
+
+    // An explicit zero precision prints nothing for zero
+    if (precision == 0 && value == 0) {
+        len = 0;
     }
-    str[i] = '\0';
-    return i;
-}
\ No newline at end of file
+
+    int zeros = 0;
+    if (precision > len) {
+        zeros = precision - len;
+    } else if (precision < 0 && (flags & FMT_ZERO) && !(flags & FMT_LEFT)) {
+        int room = width - len - (int)prefix_len;
+        zeros = room > 0 ? room : 0;
+    }
+
+    int padding = width - len - zeros - (int)prefix_len;
+
+    if (!(flags & FMT_LEFT)) {
+        fmt_pad(out, ' ', padding);
+    }
+    fmt_emit(out, prefix, prefix_len);
+    fmt_pad(out, '0', zeros);
+    fmt_emit(out, digits, len);
+    if (flags & FMT_LEFT) {
+        fmt_pad(out, ' ', padding);
+    }
+}
+
+// Format into a sink. Supports the flags "-0+ #", width and precision
+// (including '*'), the length modifiers hh, h, l, ll, z and t, and the
+// conversions d i u x X o p c s %.
+int vsinkprintf(printf_sink_t sink, void* ctx, const char* format, va_list args) {
+    fmt_out_t out = { sink, ctx, 0 };
+
+    while (*format) {
+        // Literal text up to the next conversion in one call
+        const char* run = format;
+        while (*format && *format != '%') {
+            format++;
+        }
+        fmt_emit(&out, run, format - run);
+        if (!*format) {
+            break;
+        }
+
+        const char* spec = format++;
+
+        int flags = 0;
+        while (1) {
+            if (*format == '-') flags |= FMT_LEFT;
+            else if (*format == '0') flags |= FMT_ZERO;
+            else if (*format == '+') flags |= FMT_PLUS;
+            else if (*format == ' ') flags |= FMT_SPACE;
+            else if (*format == '#') flags |= FMT_ALT;
+            else break;
+            format++;
+        }
+
+        int width = 0;
+        if (*format == '*') {
+            width = va_arg(args, int);
+            if (width < 0) {
+                flags |= FMT_LEFT;
+                width = -width;
+            }
+            format++;
+        } else {
+            while (*format >= '0' && *format <= '9') {
+                width = width * 10 + (*format++ - '0');
+            }
+        }
+
+        int precision = -1;
+        if (*format == '.') {
+            format++;
+            precision = 0;
+            if (*format == '*') {
+                precision = va_arg(args, int);
+                format++;
+            } else {
+                while (*format >= '0' && *format <= '9') {
+                    precision = precision * 10 + (*format++ - '0');
+                }
+            }
+        }
+
+        // Length modifier, as the size of the argument in bytes
+        int size = sizeof(int);
+        if (*format == 'h') {
+            format++;
+            size = sizeof(short);
+            if (*format == 'h') {
+                format++;
+                size = sizeof(char);
+            }
+        } else if (*format == 'l') {
+            format++;
+            size = sizeof(long);
+            if (*format == 'l') {
+                format++;
+                size = sizeof(long long);
+            }
+        } else if (*format == 'z') {
+            format++;
+            size = sizeof(size_t);
+        } else if (*format == 't') {
+            format++;
+            size = sizeof(ptrdiff_t);
+        }
+
+        char conv = *format;
+        if (conv) {
+            format++;
+        }
+
+        switch (conv) {
+            case 'd':
+            case 'i': {
+                int64_t value;
+                if (size == sizeof(long long)) {
+                    value = va_arg(args, long long);
+                } else if (size == sizeof(long)) {
+                    value = va_arg(args, long);
+                } else {
+                    value = va_arg(args, int);
+                    if (size == sizeof(short)) {
+                        value = (short)value;
+                    } else if (size == sizeof(char)) {
+                        value = (signed char)value;
+                    }
+                }
+                // Negate in unsigned arithmetic so INT64_MIN is safe
+                uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+                fmt_number(&out, magnitude, value < 0, 'd', flags, width, precision);
+                break;
+            }
+
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o': {
+                uint64_t value;
+                if (size == sizeof(long long)) {
+                    value = va_arg(args, unsigned long long);
+                } else if (size == sizeof(long)) {
+                    value = va_arg(args, unsigned long);
+                } else {
+                    value = va_arg(args, unsigned int);
+                    if (size == sizeof(short)) {
+                        value = (unsigned short)value;
+                    } else if (size == sizeof(char)) {
+                        value = (unsigned char)value;
+                    }
+                }
+                if (conv == 'X') {
+                    flags |= FMT_UPPER;
+                }
+                fmt_number(&out, value, false, conv, flags, width, precision);
+                break;
+            }
+
+            case 'p': {
+                uintptr_t value = (uintptr_t)va_arg(args, void*);
+                fmt_number(&out, value, false, 'p', flags | FMT_ALT, width, precision);
+                break;
+            }
+
+            case 'c': {
+                char c = (char)va_arg(args, int);
+                if (!(flags & FMT_LEFT)) {
+                    fmt_pad(&out, ' ', width - 1);
+                }
+                fmt_emit(&out, &c, 1);
+                if (flags & FMT_LEFT) {
+                    fmt_pad(&out, ' ', width - 1);
+                }
+                break;
+            }
+
+            case 's': {
+                const char* str = va_arg(args, const char*);
+                if (str == NULL) {
+                    str = "(null)";
+                }
+                int len = 0;
+                while (str[len] && (precision < 0 || len < precision)) {
+                    len++;
+                }
+                if (!(flags & FMT_LEFT)) {
+                    fmt_pad(&out, ' ', width - len);
+                }
+                fmt_emit(&out, str, len);
+                if (flags & FMT_LEFT) {
+                    fmt_pad(&out, ' ', width - len);
+                }
+                break;
+            }
+
+            case '%':
+                fmt_emit(&out, "%", 1);
+                break;
+
+            default:
+                // Unknown conversion: print it as written
+                fmt_emit(&out, spec, format - spec);
+                break;
+        }
+    }
+
+    return (int)out.count;
+}
+
+// Bounded buffer sink for vsnprintf
+typedef struct {
+    char* buffer;
+    size_t size;
+    size_t used;
+} snprintf_ctx_t;
+
+static void snprintf_sink(void* ctx, const char* data, size_t len) {
+    snprintf_ctx_t* state = (snprintf_ctx_t*)ctx;
+    if (state->used + 1 < state->size) {
+        size_t room = state->size - 1 - state->used;
+        size_t n = len < room ? len : room;
+        memcpy(state->buffer + state->used, data, n);
+        state->used += n;
+    }
+}
+
+// Format into a buffer of the given size, always NUL terminated when size
+// is non-zero. Returns the length the full output would have had.
+int vsnprintf(char* str, size_t size, const char* format, va_list args) {
+    snprintf_ctx_t state = { str, size, 0 };
+    int len = vsinkprintf(snprintf_sink, &state, format, args);
+    if (size) {
+        str[state.used] = '\0';
+    }
+    return len;
+}
+
+int snprintf(char* str, size_t size, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(str, size, format, args);
+    va_end(args);
+    return len;
+}
+
+// Unbounded; prefer snprintf()
+int sprintf(char* str, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(str, (size_t)-1 >> 1, format, args);
+    va_end(args);
+    return len;
+}
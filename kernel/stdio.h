@@ -72,6 +72,7 @@
 #define STDIO_H
 
 #include <stddef.h>
+#include <stdarg.h>
 
 // String functions
 size_t strlen(const char* str);
@@ -80,6 +81,15 @@ char* strcpy(char* dest, const char* src);
 char* strncpy(char* dest, const char* src, size_t n);
 void* memset(void* ptr, int value, size_t num);
 void* memcpy(void* dest, const void* src, size_t n);
-int sprintf(char* str, const char* format, ...);
+void* memmove(void* dest, const void* src, size_t n);
+int memcmp(const void* ptr1, const void* ptr2, size_t n);
+
+// Formatted output. The engine streams to a sink callback in chunks, so it
+// needs no intermediate buffer; the functions below are thin wrappers.
+typedef void (*printf_sink_t)(void* ctx, const char* data, size_t len);
+int vsinkprintf(printf_sink_t sink, void* ctx, const char* format, va_list args);
+int vsnprintf(char* str, size_t size, const char* format, va_list args);
+int snprintf(char* str, size_t size, const char* format, ...) __attribute__((format(printf, 3, 4)));
+int sprintf(char* str, const char* format, ...) __attribute__((format(printf, 2, 3)));
 
 #endif // STDIO_H
\ No newline at end of file
@@ -0,0 +1,147 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+#include "timer.h"
+#include "spinlock.h"
+#include "../drivers/uart.h"
+
+// Counter frequency used when the hardware cannot tell us: the RISC-V
+// timebase on QEMU virt and most SBI platforms
+#define TIMER_DEFAULT_FREQ  10000000ULL
+
+#if defined(__x86_64__)
+// PIT channel 2 is gated through port 0x61 and used to calibrate the TSC
+#define PIT_FREQ            1193182ULL
+#define PIT_CALIBRATE_MS    10
+#define PIT_PORT_CH2        0x42
+#define PIT_PORT_CMD        0x43
+#define PIT_PORT_GATE       0x61
+#endif
+
+static uint64_t counter_freq = TIMER_DEFAULT_FREQ;
+static uint64_t boot_ticks;
+
+// ns = (ticks * ns_mult) >> 32, precomputed so ktime_get_ns() never divides
+static uint64_t ns_mult;
+
+// Per-core tick period in counter ticks
+static uint64_t tick_period;
+
+// Raw clocksource counter
+uint64_t timer_ticks(void) {
+#if defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("isb\n"
+                 "mrs %0, cntpct_el0" : "=r"(ticks) :: "memory");
+    return ticks;
+#elif defined(__x86_64__)
+    uint32_t lo, hi;
+    asm volatile("lfence\n"
+                 "rdtsc" : "=a"(lo), "=d"(hi) :: "memory");
+    return ((uint64_t)hi << 32) | lo;
+#elif defined(__riscv)
+    uint64_t ticks;
+    asm volatile("rdtime %0" : "=r"(ticks));
+    return ticks;
+#else
+    return 0;
+#endif
+}
+
+#if defined(__x86_64__)
+static inline void outb(uint16_t port, uint8_t value) {
+    asm volatile("outb %0, %1" :: "a"(value), "Nd"(port));
+}
+
+static inline uint8_t inb(uint16_t port) {
+    uint8_t value;
+    asm volatile("inb %1, %0" : "=a"(value) : "Nd"(port));
+    return value;
+}
+
+// Count TSC ticks across a PIT one-shot of PIT_CALIBRATE_MS
+static uint64_t tsc_calibrate(void) {
+    uint16_t count = (uint16_t)(PIT_FREQ * PIT_CALIBRATE_MS / 1000);
+
+    // Gate channel 2 on, speaker off
+    outb(PIT_PORT_GATE, (inb(PIT_PORT_GATE) & ~0x02) | 0x01);
+
+    // Channel 2, lobyte/hibyte, mode 0 (interrupt on terminal count)
+    outb(PIT_PORT_CMD, 0xB0);
+    outb(PIT_PORT_CH2, count & 0xFF);
+    outb(PIT_PORT_CH2, count >> 8);
+
+    uint64_t start = timer_ticks();
+    while (!(inb(PIT_PORT_GATE) & 0x20)) {
+        cpu_relax();
+    }
+    uint64_t end = timer_ticks();
+
+    return (end - start) * 1000 / PIT_CALIBRATE_MS;
+}
+#endif
+
+// Read the clocksource frequency and set up the conversion factors
+void timer_init(void) {
+#if defined(__aarch64__)
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(counter_freq));
+#elif defined(__x86_64__)
+    counter_freq = tsc_calibrate();
+#endif
+    if (counter_freq == 0) {
+        counter_freq = TIMER_DEFAULT_FREQ;
+    }
+
+    ns_mult = (NSEC_PER_SEC << 32) / counter_freq;
+    boot_ticks = timer_ticks();
+
+    uart_printf("Timer: %d kHz clocksource\n", (int)(counter_freq / 1000));
+}
+
+// Clocksource frequency in Hz
+uint64_t timer_freq(void) {
+    return counter_freq;
+}
+
+// Monotonic time since boot in nanoseconds
+uint64_t ktime_get_ns(void) {
+    uint64_t delta = timer_ticks() - boot_ticks;
+    return (uint64_t)(((unsigned __int128)delta * ns_mult) >> 32);
+}
+
+// Busy-wait for at least the given number of microseconds
+void udelay(uint32_t usecs) {
+    // Round up so short delays never collapse to zero ticks
+    uint64_t wait = ((uint64_t)usecs * counter_freq + 999999) / 1000000;
+    uint64_t start = timer_ticks();
+
+    while (timer_ticks() - start < wait) {
+        cpu_relax();
+    }
+}
+
+// Busy-wait for at least the given number of milliseconds
+void mdelay(uint32_t msecs) {
+    while (msecs--) {
+        udelay(1000);
+    }
+}
+
+// Start the periodic tick at the given rate on the calling core
+void timer_tick_start(uint32_t hz) {
+    tick_period = counter_freq / hz;
+    timer_tick_rearm();
+}
+
+// Program the next periodic tick; call from the tick interrupt
+void timer_tick_rearm(void) {
+#if defined(__aarch64__)
+    // EL1 physical timer, enabled with its interrupt unmasked
+    asm volatile("msr cntp_tval_el0, %0\n"
+                 "msr cntp_ctl_el0, %1" :: "r"(tick_period), "r"(1UL) : "memory");
+#endif
+}
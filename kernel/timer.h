@@ -0,0 +1,39 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * SAGE OS is dual-licensed under the BSD 3-Clause License and a Commercial License.
+ * 
+ * This file is part of the SAGE OS Project.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "types.h"
+
+#define NSEC_PER_USEC   1000ULL
+#define NSEC_PER_MSEC   1000000ULL
+#define NSEC_PER_SEC    1000000000ULL
+
+// Read the clocksource frequency (calibrated on x86_64). Call once on the
+// boot core before using the rest of this API.
+void timer_init(void);
+
+// Raw clocksource counter and its frequency in Hz
+uint64_t timer_ticks(void);
+uint64_t timer_freq(void);
+
+// Monotonic time since boot in nanoseconds
+uint64_t ktime_get_ns(void);
+
+// Busy-wait for at least the given time
+void udelay(uint32_t usecs);
+void mdelay(uint32_t msecs);
+
+// Start the periodic tick at the given rate on the calling core
+void timer_tick_start(uint32_t hz);
+
+// Program the next periodic tick; call from the tick interrupt
+void timer_tick_rearm(void);
+
+#endif // TIMER_H
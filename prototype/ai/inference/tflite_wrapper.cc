@@ -67,28 +67,73 @@
 // Use of this software in critical systems (e.g., medical, nuclear, safety)
 // is entirely at your own risk unless specifically licensed for such purposes.
 //
-// ─────────────────────────────────────────────────────────────────────────────#include "tflite_wrapper.h"
+// ─────────────────────────────────────────────────────────────────────────────
+#include "tflite_wrapper.h"
 
 #ifdef ENABLE_AI
 
 #include <cstdint>
 #include <cstring>
+#include <new>
 
 #include "tensorflow/lite/micro/all_ops_resolver.h"
 #include "tensorflow/lite/micro/micro_error_reporter.h"
 #include "tensorflow/lite/micro/micro_interpreter.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
+// Kernel page allocator
+extern "C" {
+#include "../../../kernel/memory.h"
+}
+
 // TFLite globals
 namespace {
     tflite::ErrorReporter* error_reporter = nullptr;
-    const tflite::Model* model = nullptr;
-    tflite::MicroInterpreter* interpreter = nullptr;
     tflite::AllOpsResolver resolver;
     
-    // Arena memory for TFLite
-    constexpr int kTensorArenaSize = 128 * 1024;
-    static uint8_t tensor_arena[kTensorArenaSize];
+    // Models that can be loaded at once
+    constexpr int kMaxModels = 8;
+    
+    // Arena sizes tried for a model: start small, double until
+    // AllocateTensors() fits, give up past the largest
+    constexpr size_t kMinTensorArenaSize = 16 * 1024;
+    constexpr size_t kMaxTensorArenaSize = 4 * 1024 * 1024;
+    
+    // A loaded model with its own interpreter and tensor arena, so models
+    // stay ready to invoke side by side. The handle is the slot.
+    struct ModelSlot {
+        bool in_use;
+        const tflite::Model* model;
+        tflite::MicroInterpreter* interpreter;
+        uint8_t* arena;
+        alignas(tflite::MicroInterpreter) uint8_t storage[sizeof(tflite::MicroInterpreter)];
+    };
+    
+    ModelSlot slots[kMaxModels];
+    
+    // Slot behind a handle, or nullptr if it is not a loaded model
+    ModelSlot* slot_for(void* model_handle) {
+        for (int i = 0; i < kMaxModels; i++) {
+            if (&slots[i] == model_handle && slots[i].in_use) {
+                return &slots[i];
+            }
+        }
+        return nullptr;
+    }
+    
+    // Tear down a slot's interpreter and return its arena
+    void release_slot(ModelSlot* slot) {
+        if (slot->interpreter != nullptr) {
+            slot->interpreter->~MicroInterpreter();
+            slot->interpreter = nullptr;
+        }
+        if (slot->arena != nullptr) {
+            page_free(slot->arena);
+            slot->arena = nullptr;
+        }
+        slot->model = nullptr;
+        slot->in_use = false;
+    }
 }
 
 extern "C" {
@@ -102,33 +147,65 @@ int tflite_init(void) {
 }
 
 void* tflite_load_model(const unsigned char* model_data, unsigned int model_size) {
+    // Find a free slot
+    ModelSlot* slot = nullptr;
+    for (int i = 0; i < kMaxModels; i++) {
+        if (!slots[i].in_use) {
+            slot = &slots[i];
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        error_reporter->Report("Too many models loaded!");
+        return nullptr;
+    }
+    
     // Map the model into a usable data structure
-    model = tflite::GetModel(model_data);
+    const tflite::Model* model = tflite::GetModel(model_data);
     if (model->version() != TFLITE_SCHEMA_VERSION) {
         error_reporter->Report("Model version mismatch!");
         return nullptr;
     }
     
-    // Build an interpreter to run the model
-    static tflite::MicroInterpreter static_interpreter(
-        model, resolver, tensor_arena, kTensorArenaSize, error_reporter);
-    interpreter = &static_interpreter;
+    slot->in_use = true;
+    slot->model = model;
     
-    // Allocate tensors
-    if (interpreter->AllocateTensors() != kTfLiteOk) {
-        error_reporter->Report("AllocateTensors() failed");
-        return nullptr;
+    // Build the model's interpreter in an arena from the page allocator,
+    // growing the arena until its tensors fit
+    for (size_t size = kMinTensorArenaSize; size <= kMaxTensorArenaSize; size *= 2) {
+        unsigned int order = page_order_for_size(size);
+        slot->arena = static_cast<uint8_t*>(page_alloc(order));
+        if (slot->arena == nullptr) {
+            break;
+        }
+        
+        slot->interpreter = new (slot->storage) tflite::MicroInterpreter(
+            model, resolver, slot->arena, size, error_reporter);
+        
+        // Allocate tensors once; every invoke reuses them
+        if (slot->interpreter->AllocateTensors() == kTfLiteOk) {
+            return slot;
+        }
+        
+        slot->interpreter->~MicroInterpreter();
+        slot->interpreter = nullptr;
+        page_free(slot->arena);
+        slot->arena = nullptr;
     }
     
-    return (void*)model;
+    error_reporter->Report("AllocateTensors() failed");
+    release_slot(slot);
+    return nullptr;
 }
 
 int tflite_run_inference(void* model_handle, 
                          const float* input_data, unsigned int input_size,
                          float* output_data, unsigned int output_size) {
-    if (!interpreter) {
+    ModelSlot* slot = slot_for(model_handle);
+    if (slot == nullptr) {
         return -1;
     }
+    tflite::MicroInterpreter* interpreter = slot->interpreter;
     
     // Get input tensor
     TfLiteTensor* input = interpreter->input(0);
@@ -140,15 +217,6 @@ int tflite_run_inference(void* model_handle,
         return -2;
     }
     
-    // Copy input data
-    std::memcpy(input->data.f, input_data, input_bytes);
-    
-    // Run inference
-    if (interpreter->Invoke() != kTfLiteOk) {
-        error_reporter->Report("Invoke failed!");
-        return -3;
-    }
-    
     // Get output tensor
     TfLiteTensor* output = interpreter->output(0);
     
@@ -159,16 +227,70 @@ int tflite_run_inference(void* model_handle,
         return -4;
     }
     
-    // Copy output data
-    std::memcpy(output_data, output->data.f, output_bytes);
+    // Copy input data, unless the caller filled the tensor in place
+    if (input_data != input->data.f) {
+        std::memcpy(input->data.f, input_data, input_bytes);
+    }
+    
+    // Run inference
+    if (interpreter->Invoke() != kTfLiteOk) {
+        error_reporter->Report("Invoke failed!");
+        return -3;
+    }
+    
+    // Copy output data, unless the caller reads the tensor in place
+    if (output_data != output->data.f) {
+        std::memcpy(output_data, output->data.f, output_bytes);
+    }
+    
+    return 0;
+}
+
+float* tflite_input_buffer(void* model_handle, unsigned int* size) {
+    ModelSlot* slot = slot_for(model_handle);
+    if (slot == nullptr) {
+        return nullptr;
+    }
+    
+    TfLiteTensor* input = slot->interpreter->input(0);
+    if (size != nullptr) {
+        *size = input->bytes / sizeof(float);
+    }
+    return input->data.f;
+}
+
+float* tflite_output_buffer(void* model_handle, unsigned int* size) {
+    ModelSlot* slot = slot_for(model_handle);
+    if (slot == nullptr) {
+        return nullptr;
+    }
+    
+    TfLiteTensor* output = slot->interpreter->output(0);
+    if (size != nullptr) {
+        *size = output->bytes / sizeof(float);
+    }
+    return output->data.f;
+}
+
+int tflite_invoke(void* model_handle) {
+    ModelSlot* slot = slot_for(model_handle);
+    if (slot == nullptr) {
+        return -1;
+    }
+    
+    if (slot->interpreter->Invoke() != kTfLiteOk) {
+        error_reporter->Report("Invoke failed!");
+        return -3;
+    }
     
     return 0;
 }
 
 void tflite_unload_model(void* model_handle) {
-    // Nothing to do, as we're using static memory
-    model = nullptr;
-    interpreter = nullptr;
+    ModelSlot* slot = slot_for(model_handle);
+    if (slot != nullptr) {
+        release_slot(slot);
+    }
 }
 
 } // extern "C"
@@ -193,6 +315,18 @@ int tflite_run_inference(void* model_handle,
     return -1;
 }
 
+float* tflite_input_buffer(void* model_handle, unsigned int* size) {
+    return nullptr;
+}
+
+float* tflite_output_buffer(void* model_handle, unsigned int* size) {
+    return nullptr;
+}
+
+int tflite_invoke(void* model_handle) {
+    return -1;
+}
+
 void tflite_unload_model(void* model_handle) {
     // Do nothing
 }
@@ -66,4 +66,45 @@
 //
 // Use of this software in critical systems (e.g., medical, nuclear, safety)
 // is entirely at your own risk unless specifically licensed for such purposes.
-//
\ No newline at end of file
+//
+// ─────────────────────────────────────────────────────────────────────────────
+#ifndef TFLITE_WRAPPER_H
+#define TFLITE_WRAPPER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Set up the TensorFlow Lite Micro runtime
+int tflite_init(void);
+
+// Load a model and allocate its tensors; returns a model handle or NULL.
+// Each handle owns its own interpreter and a tensor arena from the page
+// allocator, so several models stay loaded and can be invoked in turn
+// without reallocating tensors. Up to 8 models can be loaded at once.
+void* tflite_load_model(const unsigned char* model_data, unsigned int model_size);
+
+// Copy input_size floats in, run the model and copy output_size floats out
+int tflite_run_inference(void* model_handle,
+                         const float* input_data, unsigned int input_size,
+                         float* output_data, unsigned int output_size);
+
+// Zero-copy access to the model's first input and output tensors. The
+// pointers are into the tensor arena and stay valid until the model is
+// unloaded; *size gets the tensor's element count. Fill the input in
+// place, call tflite_invoke(), then read the output in place before the
+// next invoke.
+float* tflite_input_buffer(void* model_handle, unsigned int* size);
+float* tflite_output_buffer(void* model_handle, unsigned int* size);
+
+// Run the model on the input tensor as it stands
+int tflite_invoke(void* model_handle);
+
+// Release a model, its interpreter and its arena
+void tflite_unload_model(void* model_handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TFLITE_WRAPPER_H